@@ -0,0 +1,176 @@
+// Copyright 2023 the v8go contributors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+package v8go
+
+// #include "v8go.h"
+import "C"
+
+import (
+	"errors"
+	"runtime"
+	"unsafe"
+)
+
+// ArrayBuffer is a JavaScript ArrayBuffer, whose memory can be read and
+// written from Go without copying.
+type ArrayBuffer struct {
+	*Object
+	store backingStore
+}
+
+// ArrayBufferView is a typed array or DataView, a window onto part of an
+// ArrayBuffer.
+type ArrayBufferView struct {
+	*Object
+	store backingStore
+}
+
+// backingStore is a reference to the memory of an ArrayBuffer, taken by Bytes
+// and held until the wrapper is released.
+type backingStore struct {
+	ptr  C.BackingStorePtr
+	data []byte
+}
+
+func (s *backingStore) bytes(v *Value) []byte {
+	if s.ptr == nil {
+		s.set(C.ValueGetBackingStore(v.ptr))
+	}
+	return s.data
+}
+
+func (s *backingStore) set(rtn C.RtnBackingStore) {
+	s.ptr = rtn.ptr
+	if rtn.data != nil {
+		s.data = unsafe.Slice((*byte)(rtn.data), int(rtn.byte_length))
+	}
+}
+
+func (s *backingStore) release() {
+	if s.ptr != nil {
+		C.BackingStoreRelease(s.ptr)
+		s.ptr = nil
+		s.data = nil
+	}
+}
+
+// NewArrayBuffer creates a zero-filled ArrayBuffer of the given size. Writing to
+// its Bytes fills it in place, without the copy of NewArrayBufferFromBytes.
+func NewArrayBuffer(ctx *Context, byteLength int) (*ArrayBuffer, error) {
+	if ctx == nil {
+		return nil, errors.New("v8go: Context is required")
+	}
+	rtn := C.NewArrayBuffer(ctx.ptr, nil, C.size_t(byteLength))
+	return arrayBufferResult(ctx, rtn)
+}
+
+// NewArrayBufferFromBytes creates an ArrayBuffer with a copy of data.
+//
+// V8 is built with its sandbox enabled, which requires the memory of every
+// ArrayBuffer to be allocated by V8 inside the sandbox, so neither Go nor C
+// memory can be wrapped in place. To avoid the copy, allocate the buffer with
+// NewArrayBuffer and produce the data directly into its Bytes.
+func NewArrayBufferFromBytes(ctx *Context, data []byte) (*ArrayBuffer, error) {
+	if ctx == nil {
+		return nil, errors.New("v8go: Context is required")
+	}
+	var ptr unsafe.Pointer
+	if len(data) > 0 {
+		ptr = unsafe.Pointer(&data[0])
+	}
+	rtn := C.NewArrayBuffer(ctx.ptr, ptr, C.size_t(len(data)))
+	return arrayBufferResult(ctx, rtn)
+}
+
+func arrayBufferResult(ctx *Context, rtn C.RtnValue) (*ArrayBuffer, error) {
+	obj, err := objectResult(ctx, rtn)
+	if err != nil {
+		return nil, err
+	}
+	return newArrayBuffer(obj), nil
+}
+
+func newArrayBuffer(obj *Object) *ArrayBuffer {
+	buf := &ArrayBuffer{Object: obj}
+	runtime.SetFinalizer(buf, func(buf *ArrayBuffer) { buf.store.release() })
+	return buf
+}
+
+// AsArrayBuffer returns the value as an ArrayBuffer, or an error if it is not
+// one.
+func (v *Value) AsArrayBuffer() (*ArrayBuffer, error) {
+	if !v.IsArrayBuffer() {
+		return nil, errors.New("v8go: value is not an ArrayBuffer")
+	}
+	return newArrayBuffer(&Object{v}), nil
+}
+
+// AsArrayBufferView returns the value as an ArrayBufferView, or an error if it
+// is not a typed array or DataView.
+func (v *Value) AsArrayBufferView() (*ArrayBufferView, error) {
+	if !v.IsArrayBufferView() {
+		return nil, errors.New("v8go: value is not an ArrayBufferView")
+	}
+	view := &ArrayBufferView{Object: &Object{v}}
+	runtime.SetFinalizer(view, func(view *ArrayBufferView) { view.store.release() })
+	return view, nil
+}
+
+// ByteLength returns the size of the buffer in bytes, which is zero once it has
+// been detached.
+func (b *ArrayBuffer) ByteLength() int {
+	return int(C.ArrayBufferByteLength(b.ptr))
+}
+
+// Bytes returns the memory of the buffer. The slice aliases the memory V8 uses,
+// so writes from Go are seen by JavaScript and the other way around.
+//
+// The memory stays valid until Release is called on the ArrayBuffer or it is
+// garbage collected, even if the buffer is collected or detached in JavaScript,
+// so keep the ArrayBuffer reachable while the slice is in use.
+func (b *ArrayBuffer) Bytes() []byte {
+	data := b.store.bytes(b.Value)
+	runtime.KeepAlive(b)
+	return data
+}
+
+// Release releases the memory returned by Bytes and the value itself. Using
+// the ArrayBuffer or its Bytes afterwards will result in undefined behavior.
+func (b *ArrayBuffer) Release() {
+	b.store.release()
+	b.Value.Release()
+}
+
+// Buffer returns the ArrayBuffer that the view is onto.
+func (v *ArrayBufferView) Buffer() *ArrayBuffer {
+	ptr := C.ArrayBufferViewBuffer(v.ptr)
+	return newArrayBuffer(&Object{&Value{ptr, v.ctx}})
+}
+
+// ByteOffset returns the offset of the view into its ArrayBuffer.
+func (v *ArrayBufferView) ByteOffset() int {
+	return int(C.ArrayBufferViewByteOffset(v.ptr))
+}
+
+// ByteLength returns the size of the view in bytes.
+func (v *ArrayBufferView) ByteLength() int {
+	return int(C.ArrayBufferViewByteLength(v.ptr))
+}
+
+// Bytes returns the part of the ArrayBuffer's memory covered by the view, with
+// the same aliasing and lifetime as ArrayBuffer.Bytes.
+func (v *ArrayBufferView) Bytes() []byte {
+	data := v.store.bytes(v.Value)
+	runtime.KeepAlive(v)
+	return data
+}
+
+// Release releases the memory returned by Bytes and the value itself. Using
+// the ArrayBufferView or its Bytes afterwards will result in undefined
+// behavior.
+func (v *ArrayBufferView) Release() {
+	v.store.release()
+	v.Value.Release()
+}
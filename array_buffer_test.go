@@ -0,0 +1,136 @@
+// Copyright 2023 the v8go contributors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+package v8go_test
+
+import (
+	"bytes"
+	"testing"
+
+	v8 "github.com/ionos-cloud/v8go"
+)
+
+func TestArrayBufferBytes(t *testing.T) {
+	t.Parallel()
+
+	ctx := v8.NewContext()
+	defer ctx.Isolate().Dispose()
+	defer ctx.Close()
+
+	val, err := ctx.RunScript("var u8 = new Uint8Array([1, 2, 3, 4]); u8.buffer", "buf.js")
+	fatalIf(t, err)
+	buf, err := val.AsArrayBuffer()
+	fatalIf(t, err)
+	defer buf.Release()
+
+	if buf.ByteLength() != 4 {
+		t.Errorf("expected byte length 4, got %d", buf.ByteLength())
+	}
+	data := buf.Bytes()
+	if !bytes.Equal(data, []byte{1, 2, 3, 4}) {
+		t.Errorf("unexpected bytes %v", data)
+	}
+	data[0] = 42
+	if v, _ := ctx.RunScript("u8[0]", "read.js"); v.Int32() != 42 {
+		t.Errorf("expected write from Go to be visible in JS, got %d", v.Int32())
+	}
+	ctx.RunScript("u8[1] = 43", "write.js")
+	if data[1] != 43 {
+		t.Errorf("expected write from JS to be visible in Go, got %d", data[1])
+	}
+
+	if _, err := ctx.Global().AsArrayBuffer(); err == nil {
+		t.Error("expected error for a value that is not an ArrayBuffer")
+	}
+}
+
+func TestArrayBufferView(t *testing.T) {
+	t.Parallel()
+
+	ctx := v8.NewContext()
+	defer ctx.Isolate().Dispose()
+	defer ctx.Close()
+
+	val, err := ctx.RunScript("new Uint16Array([1, 2, 3, 4]).subarray(1, 3)", "view.js")
+	fatalIf(t, err)
+	view, err := val.AsArrayBufferView()
+	fatalIf(t, err)
+	defer view.Release()
+
+	if view.ByteOffset() != 2 || view.ByteLength() != 4 {
+		t.Errorf("expected offset 2 and length 4, got %d and %d", view.ByteOffset(), view.ByteLength())
+	}
+	if data := view.Bytes(); !bytes.Equal(data, []byte{2, 0, 3, 0}) {
+		t.Errorf("unexpected bytes %v", data)
+	}
+	if buf := view.Buffer(); buf.ByteLength() != 8 {
+		t.Errorf("expected buffer byte length 8, got %d", buf.ByteLength())
+	}
+
+	if _, err := ctx.Global().AsArrayBufferView(); err == nil {
+		t.Error("expected error for a value that is not an ArrayBufferView")
+	}
+}
+
+func TestArrayBufferDetached(t *testing.T) {
+	t.Parallel()
+
+	ctx := v8.NewContext()
+	defer ctx.Isolate().Dispose()
+	defer ctx.Close()
+
+	val, _ := ctx.RunScript("var buf = new ArrayBuffer(8); buf", "buf.js")
+	buf, _ := val.AsArrayBuffer()
+	defer buf.Release()
+	data := buf.Bytes()
+
+	// the memory stays valid for Go after JS transfers the buffer away
+	_, err := v8.SerializeWithTransfer(val, val)
+	fatalIf(t, err)
+	if buf.ByteLength() != 0 {
+		t.Errorf("expected detached buffer to have length 0, got %d", buf.ByteLength())
+	}
+	data[7] = 1
+
+	val, _ = ctx.RunScript("buf", "detached.js")
+	detached, _ := val.AsArrayBuffer()
+	defer detached.Release()
+	if len(detached.Bytes()) != 0 {
+		t.Errorf("expected no bytes for a detached buffer, got %d", len(detached.Bytes()))
+	}
+}
+
+func TestNewArrayBuffer(t *testing.T) {
+	t.Parallel()
+
+	ctx := v8.NewContext()
+	defer ctx.Isolate().Dispose()
+	defer ctx.Close()
+
+	if _, err := v8.NewArrayBuffer(nil, 1); err == nil {
+		t.Error("expected error with <nil> Context")
+	}
+	if _, err := v8.NewArrayBufferFromBytes(nil, nil); err == nil {
+		t.Error("expected error with <nil> Context")
+	}
+
+	buf, err := v8.NewArrayBuffer(ctx, 3)
+	fatalIf(t, err)
+	copy(buf.Bytes(), "abc")
+	src := []byte{1, 2, 3}
+	copied, err := v8.NewArrayBufferFromBytes(ctx, src)
+	fatalIf(t, err)
+	src[0] = 9
+	empty, err := v8.NewArrayBufferFromBytes(ctx, nil)
+	fatalIf(t, err)
+
+	fn, _ := ctx.RunScript(`(a, b, c) =>
+		String.fromCharCode(...new Uint8Array(a)) === 'abc' && new Uint8Array(b).join() === '1,2,3' && c.byteLength === 0`, "check.js")
+	f, _ := fn.AsFunction()
+	rtn, err := f.Call(v8.Undefined(ctx.Isolate()), buf, copied, empty)
+	fatalIf(t, err)
+	if !rtn.Boolean() {
+		t.Error("unexpected ArrayBuffer contents")
+	}
+}
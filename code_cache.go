@@ -0,0 +1,324 @@
+// Copyright 2023 the v8go contributors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+package v8go
+
+// #include "v8go.h"
+import "C"
+
+import (
+	"container/list"
+	"crypto/sha256"
+	"encoding/binary"
+	"encoding/hex"
+	"os"
+	"path/filepath"
+	"sort"
+	"strings"
+	"sync"
+	"syscall"
+	"time"
+)
+
+// CodeCacheStore stores the code caches of compiled scripts, so that later
+// compilations of the same source, possibly in another process, can skip
+// parsing and compiling it. Set it as CompileOptions.CacheStore to have
+// CompileUnboundScript consult and fill it. Implementations must be safe for
+// concurrent use.
+type CodeCacheStore interface {
+	// Get returns the code cache stored under key. The data is only used
+	// until release is called.
+	Get(key string) (data []byte, release func(), ok bool)
+	// Put stores a code cache under key. The data must not be retained
+	// after Put returns.
+	Put(key string, data []byte)
+	// Reject is called when V8 rejected the code cache Get returned for key,
+	// so that the store can drop it.
+	Reject(key string)
+}
+
+// CodeCacheKey returns the key a code cache for source is stored under. Besides
+// the source, it covers the V8 version and the flags V8 runs with, since a code
+// cache produced under different ones is rejected.
+func CodeCacheKey(source string) string {
+	initializeIfNecessary()
+	h := sha256.New()
+	h.Write([]byte(Version()))
+	var tag [4]byte
+	binary.LittleEndian.PutUint32(tag[:], uint32(C.CachedDataVersionTag()))
+	h.Write(tag[:])
+	h.Write([]byte(source))
+	return hex.EncodeToString(h.Sum(nil))
+}
+
+func (i *Isolate) compileUnboundScriptCached(source, origin string, opts CompileOptions) (*UnboundScript, error) {
+	if opts.CachedData != nil {
+		panic("On CompileOptions, CacheStore and CachedData can't both be set")
+	}
+	store := opts.CacheStore
+	opts.CacheStore = nil
+	key := CodeCacheKey(source)
+
+	if data, release, ok := store.Get(key); ok {
+		cached := CompileOptions{CachedData: &CompilerCachedData{Bytes: data}}
+		us, err := i.CompileUnboundScript(source, origin, cached)
+		release()
+		if err != nil || !cached.CachedData.Rejected {
+			return us, err
+		}
+		store.Reject(key)
+		putCodeCache(store, key, us)
+		return us, nil
+	}
+
+	us, err := i.CompileUnboundScript(source, origin, opts)
+	if err != nil {
+		return nil, err
+	}
+	putCodeCache(store, key, us)
+	return us, nil
+}
+
+func putCodeCache(store CodeCacheStore, key string, us *UnboundScript) {
+	data := us.CreateCodeCacheData()
+	store.Put(key, data.Bytes())
+	data.Free()
+}
+
+// CreateWarmCodeCache compiles the script in the isolate of ctx, runs it and
+// then calls warmup, which should exercise the script the way representative
+// requests do, before creating a code cache for it.
+//
+// V8 compiles most functions lazily, on their first call, and a code cache
+// only contains the functions compiled by the time it is created. A cache
+// created right after compiling, like CompileOptions.CacheStore does, thus
+// leaves the functions that requests call to be compiled in every isolate that
+// consumes it. A warm cache contains them too, so that fresh isolates respond
+// to their first request about as fast as warmed up ones. warmup may be nil if
+// running the script is representative enough.
+//
+// V8 has no compile hints beyond the whole-script CompileModeEager and eagerly
+// compiling function expressions wrapped in parentheses, like
+// `const f = (function() {...})`, so a warm cache is the way to capture which
+// functions are needed.
+func CreateWarmCodeCache(ctx *Context, source, origin string, warmup func(ctx *Context) error) (*CompilerCachedData, error) {
+	us, err := ctx.Isolate().CompileUnboundScript(source, origin, CompileOptions{})
+	if err != nil {
+		return nil, err
+	}
+	if _, err := us.Run(ctx); err != nil {
+		return nil, err
+	}
+	if warmup != nil {
+		if err := warmup(ctx); err != nil {
+			return nil, err
+		}
+	}
+	return us.CreateCodeCache(), nil
+}
+
+// CodeCacheStats counts the lookups and contents of a DirCodeCacheStore.
+type CodeCacheStats struct {
+	Hits       uint64
+	Misses     uint64
+	Rejections uint64
+	Evictions  uint64
+	Entries    int
+	Bytes      int64
+}
+
+// HitRate returns the share of lookups that found a code cache V8 accepted.
+func (s CodeCacheStats) HitRate() float64 {
+	lookups := s.Hits + s.Misses
+	if lookups == 0 {
+		return 0
+	}
+	return float64(s.Hits-s.Rejections) / float64(lookups)
+}
+
+// RejectionRate returns the share of the code caches found that V8 rejected.
+func (s CodeCacheStats) RejectionRate() float64 {
+	if s.Hits == 0 {
+		return 0
+	}
+	return float64(s.Rejections) / float64(s.Hits)
+}
+
+const codeCacheExt = ".v8cache"
+
+// DirCodeCacheStore is a CodeCacheStore that keeps every code cache in a file
+// of a directory. Code caches are memory mapped rather than read, so V8
+// consumes them without copying. When the files grow past the maximum size,
+// the least recently used are removed.
+type DirCodeCacheStore struct {
+	dir      string
+	maxBytes int64
+
+	mu      sync.Mutex
+	lru     *list.List // of *codeCacheEntry, most recently used first
+	entries map[string]*list.Element
+	stats   CodeCacheStats
+}
+
+type codeCacheEntry struct {
+	key  string
+	size int64
+}
+
+// NewDirCodeCacheStore opens the code caches in dir, creating it if needed. A
+// maxBytes of zero means no limit. The recency of the existing entries is taken
+// from their modification times.
+func NewDirCodeCacheStore(dir string, maxBytes int64) (*DirCodeCacheStore, error) {
+	if err := os.MkdirAll(dir, 0o755); err != nil {
+		return nil, err
+	}
+	files, err := os.ReadDir(dir)
+	if err != nil {
+		return nil, err
+	}
+
+	type file struct {
+		key     string
+		size    int64
+		modTime time.Time
+	}
+	var existing []file
+	for _, f := range files {
+		if f.IsDir() || !strings.HasSuffix(f.Name(), codeCacheExt) {
+			continue
+		}
+		info, err := f.Info()
+		if err != nil {
+			continue
+		}
+		existing = append(existing, file{strings.TrimSuffix(f.Name(), codeCacheExt), info.Size(), info.ModTime()})
+	}
+	sort.Slice(existing, func(i, j int) bool { return existing[i].modTime.Before(existing[j].modTime) })
+
+	s := &DirCodeCacheStore{
+		dir:      dir,
+		maxBytes: maxBytes,
+		lru:      list.New(),
+		entries:  make(map[string]*list.Element),
+	}
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	for _, f := range existing {
+		s.add(f.key, f.size)
+	}
+	s.evict()
+	return s, nil
+}
+
+func (s *DirCodeCacheStore) path(key string) string {
+	return filepath.Join(s.dir, key+codeCacheExt)
+}
+
+// Get maps the code cache stored under key into memory.
+func (s *DirCodeCacheStore) Get(key string) ([]byte, func(), bool) {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+
+	el, ok := s.entries[key]
+	if !ok {
+		s.stats.Misses++
+		return nil, nil, false
+	}
+	data, err := mmapFile(s.path(key))
+	if err != nil || len(data) == 0 {
+		s.remove(el)
+		s.stats.Misses++
+		return nil, nil, false
+	}
+	s.stats.Hits++
+	s.lru.MoveToFront(el)
+	now := time.Now()
+	os.Chtimes(s.path(key), now, now)
+	return data, func() { syscall.Munmap(data) }, true
+}
+
+// Put writes the code cache to the file for key, replacing it atomically so
+// that concurrent readers in other processes never see a partial entry.
+func (s *DirCodeCacheStore) Put(key string, data []byte) {
+	if len(data) == 0 {
+		return
+	}
+	tmp, err := os.CreateTemp(s.dir, ".tmp-*")
+	if err != nil {
+		return
+	}
+	_, err = tmp.Write(data)
+	if cerr := tmp.Close(); err == nil {
+		err = cerr
+	}
+	if err == nil {
+		err = os.Rename(tmp.Name(), s.path(key))
+	}
+	if err != nil {
+		os.Remove(tmp.Name())
+		return
+	}
+
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	if el, ok := s.entries[key]; ok {
+		s.stats.Bytes -= el.Value.(*codeCacheEntry).size
+		s.lru.Remove(el)
+		delete(s.entries, key)
+		s.stats.Entries--
+	}
+	s.add(key, int64(len(data)))
+	s.evict()
+}
+
+// Reject removes the code cache stored under key.
+func (s *DirCodeCacheStore) Reject(key string) {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	s.stats.Rejections++
+	if el, ok := s.entries[key]; ok {
+		s.remove(el)
+	}
+}
+
+// Stats returns the counters of the store.
+func (s *DirCodeCacheStore) Stats() CodeCacheStats {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	return s.stats
+}
+
+func (s *DirCodeCacheStore) add(key string, size int64) {
+	s.entries[key] = s.lru.PushFront(&codeCacheEntry{key, size})
+	s.stats.Entries++
+	s.stats.Bytes += size
+}
+
+func (s *DirCodeCacheStore) remove(el *list.Element) {
+	e := s.lru.Remove(el).(*codeCacheEntry)
+	delete(s.entries, e.key)
+	s.stats.Entries--
+	s.stats.Bytes -= e.size
+	os.Remove(s.path(e.key))
+}
+
+func (s *DirCodeCacheStore) evict() {
+	for s.maxBytes > 0 && s.stats.Bytes > s.maxBytes {
+		s.remove(s.lru.Back())
+		s.stats.Evictions++
+	}
+}
+
+func mmapFile(path string) ([]byte, error) {
+	f, err := os.Open(path)
+	if err != nil {
+		return nil, err
+	}
+	defer f.Close()
+	info, err := f.Stat()
+	if err != nil || info.Size() == 0 {
+		return nil, err
+	}
+	return syscall.Mmap(int(f.Fd()), 0, int(info.Size()), syscall.PROT_READ, syscall.MAP_SHARED)
+}
@@ -0,0 +1,156 @@
+// Copyright 2023 the v8go contributors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+package v8go_test
+
+import (
+	"os"
+	"path/filepath"
+	"testing"
+
+	v8 "github.com/ionos-cloud/v8go"
+)
+
+func TestDirCodeCacheStore(t *testing.T) {
+	t.Parallel()
+
+	dir := t.TempDir()
+	store, err := v8.NewDirCodeCacheStore(dir, 0)
+	fatalIf(t, err)
+	source := "function add(a, b) { return a + b }; add(1, 2)"
+	opts := v8.CompileOptions{CacheStore: store}
+
+	compile := func() {
+		iso := v8.NewIsolate()
+		defer iso.Dispose()
+		us, err := iso.CompileUnboundScript(source, "add.js", opts)
+		fatalIf(t, err)
+		ctx := v8.NewContext(iso)
+		defer ctx.Close()
+		val, err := us.Run(ctx)
+		fatalIf(t, err)
+		if val.Int32() != 3 {
+			t.Errorf("expected 3, got %v", val)
+		}
+	}
+
+	compile()
+	if s := store.Stats(); s.Misses != 1 || s.Hits != 0 || s.Entries != 1 || s.Bytes == 0 {
+		t.Errorf("expected a miss that stores the code cache, got %+v", s)
+	}
+	compile()
+	if s := store.Stats(); s.Hits != 1 || s.Rejections != 0 || s.HitRate() != 0.5 {
+		t.Errorf("expected an accepted hit, got %+v", s)
+	}
+
+	// a corrupted entry is rejected and replaced
+	path := filepath.Join(dir, v8.CodeCacheKey(source)+".v8cache")
+	fatalIf(t, os.WriteFile(path, []byte("not a code cache"), 0o644))
+	compile()
+	if s := store.Stats(); s.Hits != 2 || s.Rejections != 1 || s.Entries != 1 {
+		t.Errorf("expected the corrupted entry to be rejected, got %+v", s)
+	}
+	compile()
+	if s := store.Stats(); s.Hits != 3 || s.Rejections != 1 {
+		t.Errorf("expected the replaced entry to be accepted, got %+v", s)
+	}
+
+	// entries persist across stores
+	reopened, err := v8.NewDirCodeCacheStore(dir, 0)
+	fatalIf(t, err)
+	if s := reopened.Stats(); s.Entries != 1 {
+		t.Errorf("expected the entry to persist, got %+v", s)
+	}
+
+	if v8.CodeCacheKey(source) == v8.CodeCacheKey(source+" ") {
+		t.Error("expected different sources to have different keys")
+	}
+
+	iso := v8.NewIsolate()
+	defer iso.Dispose()
+	if _, err := iso.CompileUnboundScript("invalid js", "bad.js", opts); err == nil {
+		t.Error("expected error compiling invalid script")
+	}
+	if recoverPanic(func() {
+		iso.CompileUnboundScript(source, "add.js", v8.CompileOptions{CacheStore: store, CachedData: &v8.CompilerCachedData{}})
+	}) == nil {
+		t.Error("expected panic with both CacheStore and CachedData")
+	}
+}
+
+func TestDirCodeCacheStoreEviction(t *testing.T) {
+	t.Parallel()
+
+	store, err := v8.NewDirCodeCacheStore(t.TempDir(), 30)
+	fatalIf(t, err)
+	store.Put("a", make([]byte, 10))
+	store.Put("b", make([]byte, 10))
+	store.Put("c", make([]byte, 10))
+	if _, release, ok := store.Get("a"); ok {
+		release()
+	} else {
+		t.Fatal("expected entry a")
+	}
+	store.Put("d", make([]byte, 10))
+
+	if _, _, ok := store.Get("b"); ok {
+		t.Error("expected the least recently used entry to be evicted")
+	}
+	for _, key := range []string{"a", "c", "d"} {
+		data, release, ok := store.Get(key)
+		if !ok || len(data) != 10 {
+			t.Errorf("expected entry %s to be kept", key)
+			continue
+		}
+		release()
+	}
+	if s := store.Stats(); s.Evictions != 1 || s.Entries != 3 || s.Bytes != 30 {
+		t.Errorf("unexpected stats %+v", s)
+	}
+}
+
+func TestCreateWarmCodeCache(t *testing.T) {
+	t.Parallel()
+
+	source := `
+		function parse(s) { return s.split(',').map(Number) }
+		function sum(s) { return parse(s).reduce((a, b) => a + b, 0) }`
+
+	ctx := v8.NewContext()
+	defer ctx.Isolate().Dispose()
+	defer ctx.Close()
+	cold, err := v8.CreateWarmCodeCache(ctx, source, "sum.js", nil)
+	fatalIf(t, err)
+
+	ctx = v8.NewContext()
+	defer ctx.Isolate().Dispose()
+	defer ctx.Close()
+	warm, err := v8.CreateWarmCodeCache(ctx, source, "sum.js", func(ctx *v8.Context) error {
+		_, err := ctx.RunScript("sum('1,2,3')", "warmup.js")
+		return err
+	})
+	fatalIf(t, err)
+	if len(warm.Bytes) <= len(cold.Bytes) {
+		t.Errorf("expected the warm code cache to contain more functions, got %d bytes and %d cold", len(warm.Bytes), len(cold.Bytes))
+	}
+
+	iso := v8.NewIsolate()
+	defer iso.Dispose()
+	us, err := iso.CompileUnboundScript(source, "sum.js", v8.CompileOptions{CachedData: warm})
+	fatalIf(t, err)
+	if warm.Rejected {
+		t.Error("expected the warm code cache to be accepted")
+	}
+	fresh := v8.NewContext(iso)
+	defer fresh.Close()
+	_, err = us.Run(fresh)
+	fatalIf(t, err)
+	if val, _ := fresh.RunScript("sum('4,5')", "call.js"); val.Int32() != 9 {
+		t.Errorf("expected 9, got %v", val)
+	}
+
+	if _, err := v8.CreateWarmCodeCache(ctx, "throw new Error('boom')", "throw.js", nil); err == nil {
+		t.Error("expected error running the script")
+	}
+}
@@ -9,8 +9,8 @@ package v8go
 import "C"
 
 import (
-	"runtime"
 	"sync"
+	"time"
 	"unsafe"
 )
 
@@ -34,11 +34,49 @@ type Context struct {
 	ref int
 	ptr C.ContextPtr
 	iso *Isolate
+
+	modMutex   sync.Mutex
+	modules    map[string]*Module
+	modulePtrs map[C.ModulePtr]*Module
+	resolver   ModuleResolver
+
+	importHandler     DynamicImportHandler
+	importMetaHandler ImportMetaHandler
+
+	// the templates instantiated in the context, kept alive with it so that
+	// the callbacks of its functions stay registered
+	tmplMutex sync.Mutex
+	templates map[*template]struct{}
 }
 
 type contextOptions struct {
-	iso   *Isolate
-	gTmpl *ObjectTemplate
+	iso            *Isolate
+	gTmpl          *ObjectTemplate
+	microtaskQueue *MicrotaskQueue
+}
+
+// MicrotasksPolicy defines when the microtasks of a MicrotaskQueue run.
+type MicrotasksPolicy int
+
+const (
+	// MicrotasksExplicit runs microtasks only on PerformMicrotaskCheckpoint.
+	MicrotasksExplicit MicrotasksPolicy = 0
+	// MicrotasksAuto also runs microtasks whenever a call into JavaScript
+	// returns to Go, like the default microtask queue of an isolate does.
+	MicrotasksAuto MicrotasksPolicy = 2
+)
+
+// MicrotaskQueue is a ContextOption giving the context a microtask queue of
+// its own. By default, the contexts of an isolate share its microtask queue,
+// so each of them also runs the promise reactions of the others, both on
+// PerformMicrotaskCheckpoint and when returning from JavaScript; a context
+// with its own queue only ever runs its own microtasks.
+type MicrotaskQueue struct {
+	Policy MicrotasksPolicy
+}
+
+func (q MicrotaskQueue) apply(opts *contextOptions) {
+	opts.microtaskQueue = &q
 }
 
 // ContextOption sets options such as Isolate and Global Template to the NewContext
@@ -69,21 +107,42 @@ func NewContext(opt ...ContextOption) *Context {
 	ref := ctxSeq
 	ctxMutex.Unlock()
 
+	policy := -1
+	if opts.microtaskQueue != nil {
+		policy = int(opts.microtaskQueue.Policy)
+	}
+
 	ctx := &Context{
 		ref: ref,
-		ptr: C.NewContext(opts.iso.ptr, opts.gTmpl.ptr, C.int(ref)),
+		ptr: C.NewContext(opts.iso.ptr, opts.gTmpl.ptr, C.int(ref), C.int(policy)),
 		iso: opts.iso,
 	}
 	ctx.register()
-	runtime.KeepAlive(opts.gTmpl)
+	ctx.retainTemplate(opts.gTmpl.template)
 	return ctx
 }
 
+func (c *Context) retainTemplate(t *template) {
+	c.tmplMutex.Lock()
+	defer c.tmplMutex.Unlock()
+	if c.templates == nil {
+		c.templates = make(map[*template]struct{})
+	}
+	c.templates[t] = struct{}{}
+}
+
 // Isolate gets the current context's parent isolate.
 func (c *Context) Isolate() *Isolate {
 	return c.iso
 }
 
+// GetExecutionStatistics returns the time spent running in the context, which
+// is counted for each call entering it from Go, including the JavaScript of
+// other contexts it calls. A closed context returns zero statistics.
+func (c *Context) GetExecutionStatistics() ExecutionStatistics {
+	return newExecutionStatistics(C.ContextGetExecutionUsage(c.ptr))
+}
+
 func (c *Context) RetainedValueCount() int {
 	ctxMutex.Lock()
 	defer ctxMutex.Unlock()
@@ -99,10 +158,26 @@ func (c *Context) RunScript(source string, origin string) (*Value, error) {
 	defer C.free(unsafe.Pointer(cSource))
 	defer C.free(unsafe.Pointer(cOrigin))
 
+	c.iso.releasePendingScripts()
 	rtn := C.RunScript(c.ptr, cSource, cOrigin)
 	return valueResult(c, rtn)
 }
 
+// RunScriptWithTimeout executes the source like RunScript, terminating it if
+// it runs for longer than timeout, in which case the error is
+// ErrDeadlineExceeded. The isolate can be used again right away: the
+// termination never affects the calls that follow.
+func (c *Context) RunScriptWithTimeout(source string, origin string, timeout time.Duration) (*Value, error) {
+	var val *Value
+	var err error
+	if c.iso.withDeadline(time.Now().Add(timeout), func() {
+		val, err = c.RunScript(source, origin)
+	}) && err != nil {
+		return nil, ErrDeadlineExceeded
+	}
+	return val, err
+}
+
 // Global returns the global proxy object.
 // Global proxy object is a thin wrapper whose prototype points to actual
 // context's global object with the properties like Object, etc. This is
@@ -116,18 +191,24 @@ func (c *Context) Global() *Object {
 	return &Object{v}
 }
 
-// PerformMicrotaskCheckpoint runs the default MicrotaskQueue until empty.
+// PerformMicrotaskCheckpoint runs the microtask queue of the context until
+// empty, which is the default queue of the isolate unless the context was
+// created with a MicrotaskQueue option.
 // This is used to make progress on Promises.
 func (c *Context) PerformMicrotaskCheckpoint() {
-	C.IsolatePerformMicrotaskCheckpoint(c.iso.ptr)
+	C.ContextPerformMicrotaskCheckpoint(c.ptr)
 }
 
 // Close will dispose the context and free the memory.
 // Access to any values associated with the context after calling Close may panic.
 func (c *Context) Close() {
+	c.iso.releasePendingScripts()
 	c.deregister()
 	C.ContextFree(c.ptr)
 	c.ptr = nil
+	c.tmplMutex.Lock()
+	c.templates = nil
+	c.tmplMutex.Unlock()
 }
 
 func (c *Context) register() {
@@ -167,6 +248,9 @@ func getContext(ref int) *Context {
 //export goContext
 func goContext(ref int) C.ContextPtr {
 	ctx := getContext(ref)
+	if ctx == nil {
+		return nil
+	}
 	return ctx.ptr
 }
 
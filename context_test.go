@@ -7,7 +7,9 @@ package v8go_test
 import (
 	"encoding/json"
 	"fmt"
+	"sync"
 	"testing"
+	"time"
 
 	v8 "github.com/ionos-cloud/v8go"
 )
@@ -114,6 +116,130 @@ func TestMemoryLeak(t *testing.T) {
 	}
 }
 
+func TestContextMicrotaskQueue(t *testing.T) {
+	t.Parallel()
+
+	iso := v8.NewIsolate()
+	defer iso.Dispose()
+	explicit := v8.NewContext(iso, v8.MicrotaskQueue{Policy: v8.MicrotasksExplicit})
+	defer explicit.Close()
+	auto := v8.NewContext(iso, v8.MicrotaskQueue{Policy: v8.MicrotasksAuto})
+	defer auto.Close()
+	shared := v8.NewContext(iso)
+	defer shared.Close()
+
+	const source = "globalThis.done = false; Promise.resolve().then(() => { done = true })"
+	for _, ctx := range []*v8.Context{explicit, auto} {
+		if _, err := ctx.RunScript(source, "queue.js"); err != nil {
+			t.Fatal(err)
+		}
+	}
+	if val, _ := auto.RunScript("done", "done.js"); !val.Boolean() {
+		t.Error("expected the microtask to run on return with the auto policy")
+	}
+	if val, _ := explicit.RunScript("done", "done.js"); val.Boolean() {
+		t.Error("expected the microtask to wait for a checkpoint with the explicit policy")
+	}
+
+	// other contexts do not run the microtasks of the queue
+	shared.RunScript("Promise.resolve()", "other.js")
+	shared.PerformMicrotaskCheckpoint()
+	auto.PerformMicrotaskCheckpoint()
+	if val, _ := explicit.RunScript("done", "done.js"); val.Boolean() {
+		t.Error("expected the microtask to be run only by its own context")
+	}
+	explicit.PerformMicrotaskCheckpoint()
+	if val, _ := explicit.RunScript("done", "done.js"); !val.Boolean() {
+		t.Error("expected the checkpoint to run the microtask")
+	}
+
+	for i := 0; i < 100; i++ {
+		ctx := v8.NewContext(iso, v8.MicrotaskQueue{Policy: v8.MicrotasksExplicit})
+		ctx.RunScript("Promise.resolve().then(() => {})", "pending.js")
+		ctx.Close()
+	}
+
+	// a closed context still reachable from another one keeps using its queue
+	closed := v8.NewContext(iso, v8.MicrotaskQueue{Policy: v8.MicrotasksExplicit})
+	fn, err := closed.RunScript("() => Promise.resolve().then(() => 'later')", "closed.js")
+	fatalIf(t, err)
+	fatalIf(t, shared.Global().Set("enqueue", fn))
+	closed.Close()
+	for i := 0; i < 10; i++ {
+		if _, err := shared.RunScript("enqueue()", "enqueue.js"); err != nil {
+			t.Error(err)
+		}
+	}
+}
+
+func TestContextMicrotaskQueueLeak(t *testing.T) {
+	t.Parallel()
+
+	iso := v8.NewIsolate()
+	defer iso.Dispose()
+
+	called := 0
+	global := v8.NewObjectTemplate(iso)
+	fatalIf(t, global.Set("callback", v8.NewFunctionTemplate(iso, func(info *v8.FunctionCallbackInfo) *v8.Value {
+		called++
+		return nil
+	})))
+	for i := 0; i < 6000; i++ {
+		ctx := v8.NewContext(iso, global, v8.MicrotaskQueue{Policy: v8.MicrotasksExplicit})
+		_, _ = ctx.RunScript("Promise.resolve().then(() => {}); Promise.resolve().then(callback)", "pending.js")
+		ctx.Close()
+	}
+	if n := iso.GetHeapStatistics().NumberOfNativeContexts; n >= 6000 {
+		t.Errorf("Context not being GC'd, got %d native contexts", n)
+	}
+	if called != 0 {
+		t.Errorf("expected the pending microtasks to be dropped on close, %d ran", called)
+	}
+}
+
+func TestContextRunScriptWithTimeout(t *testing.T) {
+	t.Parallel()
+
+	iso := v8.NewIsolate()
+	defer iso.Dispose()
+	ctx := v8.NewContext(iso)
+	defer ctx.Close()
+
+	start := time.Now()
+	if _, err := ctx.RunScriptWithTimeout("while (true) {}", "loop.js", 20*time.Millisecond); err != v8.ErrDeadlineExceeded {
+		t.Errorf("expected ErrDeadlineExceeded, got %v", err)
+	}
+	if elapsed := time.Since(start); elapsed > time.Second {
+		t.Errorf("expected the script to be terminated after 20ms, took %v", elapsed)
+	}
+	// the termination does not carry over to the next calls
+	if val, err := ctx.RunScript("1 + 1", "next.js"); err != nil || val.Int32() != 2 {
+		t.Errorf("expected 2, got %v (%v)", val, err)
+	}
+	if val, err := ctx.RunScriptWithTimeout("2 + 2", "fast.js", time.Second); err != nil || val.Int32() != 4 {
+		t.Errorf("expected 4, got %v (%v)", val, err)
+	}
+	if _, err := ctx.RunScriptWithTimeout("throw new Error('boom')", "throw.js", time.Second); err == nil || err == v8.ErrDeadlineExceeded {
+		t.Errorf("expected the error of the script, got %v", err)
+	}
+
+	// one watchdog serves concurrent calls on many isolates
+	var wg sync.WaitGroup
+	for i := 1; i <= 8; i++ {
+		wg.Add(1)
+		go func(timeout time.Duration) {
+			defer wg.Done()
+			ctx := v8.NewContext()
+			defer ctx.Isolate().Dispose()
+			defer ctx.Close()
+			if _, err := ctx.RunScriptWithTimeout("while (true) {}", "loop.js", timeout); err != v8.ErrDeadlineExceeded {
+				t.Errorf("expected ErrDeadlineExceeded, got %v", err)
+			}
+		}(time.Duration(i) * 5 * time.Millisecond)
+	}
+	wg.Wait()
+}
+
 // https://github.com/rogchap/v8go/issues/186
 func TestRegistryFromJSON(t *testing.T) {
 	t.Parallel()
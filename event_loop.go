@@ -0,0 +1,352 @@
+// Copyright 2023 the v8go contributors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+package v8go
+
+import (
+	"container/heap"
+	"context"
+	"math"
+	"sync"
+	"time"
+)
+
+// EventLoop runs the asynchronous work of a context: the callbacks of the
+// setTimeout and setInterval timers it installs in the context, and the tasks
+// queued from Go with Enqueue. Like the event loop of a browser it runs one
+// task at a time, in the order they became ready, and performs a microtask
+// checkpoint after each of them, so that promises settled by a task make
+// progress before the next one.
+//
+// Run blocks without spinning while no task is ready. Each EventLoop is run
+// from its own goroutine; as a task holds the isolate for as long as it runs,
+// the event loops of contexts that share an isolate take turns task by task.
+type EventLoop struct {
+	ctx       *Context
+	undefined *Value
+
+	mu       sync.Mutex
+	tasks    []loopTask
+	timers   timerQueue
+	active   map[int32]*loopTimer
+	running  *loopTimer
+	timerSeq int32
+	seq      uint64
+	holds    int
+	wake     chan struct{}
+}
+
+type loopTask struct {
+	fn     func() error
+	queued time.Time
+}
+
+type loopTimer struct {
+	id       int32
+	when     time.Time
+	seq      uint64
+	interval time.Duration
+	repeat   bool
+	fn       *Function
+	args     []Valuer
+	idValue  *Value
+	index    int
+}
+
+// NewEventLoop creates an EventLoop for the context and installs the
+// setTimeout, setInterval, clearTimeout and clearInterval functions in its
+// global object.
+func NewEventLoop(ctx *Context) *EventLoop {
+	l := &EventLoop{
+		ctx:       ctx,
+		undefined: Undefined(ctx.iso),
+		active:    make(map[int32]*loopTimer),
+		wake:      make(chan struct{}, 1),
+	}
+	global := ctx.Global()
+	for _, fn := range []struct {
+		name string
+		cb   FunctionCallback
+	}{
+		{"setTimeout", func(info *FunctionCallbackInfo) *Value { return l.setTimer(info, false) }},
+		{"setInterval", func(info *FunctionCallbackInfo) *Value { return l.setTimer(info, true) }},
+		{"clearTimeout", l.clearTimer},
+		{"clearInterval", l.clearTimer},
+	} {
+		global.Set(fn.name, NewFunctionTemplate(ctx.iso, fn.cb).GetFunction(ctx))
+	}
+	return l
+}
+
+// Enqueue queues a task to be run by the event loop, after the tasks that are
+// already ready. A task returning an error stops Run, which returns the error.
+// Enqueue is safe to call from any goroutine, which makes it the way for Go
+// code working in the background to hand its results back to the context.
+func (l *EventLoop) Enqueue(task func() error) {
+	l.mu.Lock()
+	l.tasks = append(l.tasks, loopTask{task, time.Now()})
+	l.mu.Unlock()
+	l.signal()
+}
+
+// Hold keeps Run from returning while it has nothing left to do, until the
+// returned function is called. It is meant for Go code that will Enqueue a
+// task later, such as once a request completes. Hold is safe to call from
+// any goroutine.
+func (l *EventLoop) Hold() (release func()) {
+	l.mu.Lock()
+	l.holds++
+	l.mu.Unlock()
+	var once sync.Once
+	return func() {
+		once.Do(func() {
+			l.mu.Lock()
+			l.holds--
+			l.mu.Unlock()
+			l.signal()
+		})
+	}
+}
+
+// Run runs the tasks and timers of the event loop until there are none left
+// and nothing holds the loop, or until ctx is done, in which case it returns
+// ctx.Err(). An exception thrown by a timer callback stops Run, which returns
+// it as a `JSError`; calling Run again resumes the loop. Run must not be
+// called concurrently.
+func (l *EventLoop) Run(ctx context.Context) error {
+	var wait *time.Timer
+	defer func() {
+		if wait != nil {
+			wait.Stop()
+		}
+	}()
+
+	for {
+		if err := ctx.Err(); err != nil {
+			return err
+		}
+		task, next, alive := l.next()
+		if task != nil {
+			err := task()
+			l.ctx.PerformMicrotaskCheckpoint()
+			if err != nil {
+				return err
+			}
+			continue
+		}
+		if !alive {
+			return nil
+		}
+
+		var timeout <-chan time.Time
+		if next >= 0 {
+			if wait == nil {
+				wait = time.NewTimer(next)
+			} else {
+				wait.Reset(next)
+			}
+			timeout = wait.C
+		}
+		select {
+		case <-l.wake:
+		case <-timeout:
+			continue
+		case <-ctx.Done():
+			return ctx.Err()
+		}
+		if timeout != nil && !wait.Stop() {
+			<-wait.C
+		}
+	}
+}
+
+// next returns the task that has been ready the longest, or else how long
+// until the next timer is due, or -1 if there is none, and whether the loop
+// is still alive.
+func (l *EventLoop) next() (task func() error, next time.Duration, alive bool) {
+	l.mu.Lock()
+	defer l.mu.Unlock()
+
+	now := time.Now()
+	var t *loopTimer
+	if len(l.timers) > 0 && !l.timers[0].when.After(now) {
+		t = l.timers[0]
+	}
+	if len(l.tasks) > 0 && (t == nil || l.tasks[0].queued.Before(t.when)) {
+		task = l.tasks[0].fn
+		l.tasks[0] = loopTask{}
+		l.tasks = l.tasks[1:]
+		return task, 0, true
+	}
+	if t != nil {
+		heap.Pop(&l.timers)
+		l.running = t
+		return func() error { return l.fire(t) }, 0, true
+	}
+
+	next = -1
+	if len(l.timers) > 0 {
+		next = l.timers[0].when.Sub(now)
+	}
+	return nil, next, len(l.timers) > 0 || l.holds > 0
+}
+
+func (l *EventLoop) fire(t *loopTimer) error {
+	val, err := t.fn.Call(l.undefined, t.args...)
+	if err == nil {
+		val.Release()
+	}
+
+	l.mu.Lock()
+	l.running = nil
+	if _, ok := l.active[t.id]; ok && t.repeat && err == nil {
+		l.schedule(t, time.Now())
+		l.mu.Unlock()
+		return nil
+	}
+	delete(l.active, t.id)
+	l.mu.Unlock()
+	t.release()
+	return err
+}
+
+// schedule queues the timer to be due its interval after now.
+// l.mu must be held.
+func (l *EventLoop) schedule(t *loopTimer, now time.Time) {
+	l.seq++
+	t.seq = l.seq
+	t.when = now.Add(t.interval)
+	heap.Push(&l.timers, t)
+}
+
+func (l *EventLoop) signal() {
+	select {
+	case l.wake <- struct{}{}:
+	default:
+	}
+}
+
+func (l *EventLoop) setTimer(info *FunctionCallbackInfo, repeat bool) *Value {
+	// the callback and its arguments are kept by the timer, the rest of the
+	// values of the call are released so that they do not pile up in the
+	// context of a long-running loop
+	args := info.Args()
+	defer info.This().Release()
+	if len(args) > 1 {
+		defer args[1].Release()
+	}
+	if len(args) == 0 || !args[0].IsFunction() {
+		for i, arg := range args {
+			if i != 1 {
+				arg.Release()
+			}
+		}
+		return throwTypeError(info.Context(), "The callback must be a function")
+	}
+	fn, _ := args[0].AsFunction()
+	t := &loopTimer{fn: fn, repeat: repeat}
+	if len(args) > 1 {
+		// like browsers, delays below 1ms, or that are not numbers, wait 1ms
+		if ms := args[1].Number(); ms >= 1 && ms <= math.MaxInt32 {
+			t.interval = time.Duration(ms * float64(time.Millisecond))
+		}
+	}
+	if t.interval == 0 {
+		t.interval = time.Millisecond
+	}
+	if len(args) > 2 {
+		for _, arg := range args[2:] {
+			t.args = append(t.args, arg)
+		}
+	}
+
+	l.mu.Lock()
+	l.timerSeq++
+	t.id = l.timerSeq
+	// the id is released with the timer rather than tracked by the context
+	// for as long as it lives
+	t.idValue, _ = NewValue(info.Context().iso, t.id)
+	l.active[t.id] = t
+	l.schedule(t, time.Now())
+	l.mu.Unlock()
+	l.signal()
+	return t.idValue
+}
+
+func (l *EventLoop) clearTimer(info *FunctionCallbackInfo) *Value {
+	defer info.Release()
+	args := info.Args()
+	if len(args) == 0 || !args[0].IsNumber() {
+		return nil
+	}
+	id := args[0].Int32()
+
+	l.mu.Lock()
+	t, ok := l.active[id]
+	if !ok {
+		l.mu.Unlock()
+		return nil
+	}
+	delete(l.active, id)
+	running := t == l.running
+	if !running {
+		heap.Remove(&l.timers, t.index)
+	}
+	l.mu.Unlock()
+	if !running {
+		// a running timer is released once its callback returns
+		t.release()
+	}
+	return nil
+}
+
+func (t *loopTimer) release() {
+	t.fn.Release()
+	t.idValue.Release()
+	for _, arg := range t.args {
+		arg.(*Value).Release()
+	}
+}
+
+func throwTypeError(ctx *Context, msg string) *Value {
+	typeError, _ := ctx.Global().Get("TypeError")
+	fn, _ := typeError.AsFunction()
+	m, _ := NewValue(ctx.iso, msg)
+	exception, _ := fn.NewInstance(m)
+	return ctx.iso.ThrowException(exception.Value)
+}
+
+// timerQueue is a heap of timers ordered by when they are due, then by when
+// they were scheduled.
+type timerQueue []*loopTimer
+
+func (q timerQueue) Len() int { return len(q) }
+
+func (q timerQueue) Less(i, j int) bool {
+	if q[i].when.Equal(q[j].when) {
+		return q[i].seq < q[j].seq
+	}
+	return q[i].when.Before(q[j].when)
+}
+
+func (q timerQueue) Swap(i, j int) {
+	q[i], q[j] = q[j], q[i]
+	q[i].index = i
+	q[j].index = j
+}
+
+func (q *timerQueue) Push(x interface{}) {
+	t := x.(*loopTimer)
+	t.index = len(*q)
+	*q = append(*q, t)
+}
+
+func (q *timerQueue) Pop() interface{} {
+	old := *q
+	t := old[len(old)-1]
+	old[len(old)-1] = nil
+	t.index = -1
+	*q = old[:len(old)-1]
+	return t
+}
@@ -0,0 +1,140 @@
+// Copyright 2023 the v8go contributors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+package v8go_test
+
+import (
+	"context"
+	"errors"
+	"strings"
+	"testing"
+	"time"
+
+	v8 "github.com/ionos-cloud/v8go"
+)
+
+func TestEventLoopTimers(t *testing.T) {
+	t.Parallel()
+
+	ctx := v8.NewContext()
+	defer ctx.Isolate().Dispose()
+	defer ctx.Close()
+	loop := v8.NewEventLoop(ctx)
+
+	_, err := ctx.RunScript(`
+		const log = [];
+		setTimeout((a, b) => log.push('timeout 20 ' + a + b), 20, 'x', 'y');
+		setTimeout(() => {
+			log.push('timeout 0');
+			Promise.resolve().then(() => log.push('microtask'));
+		});
+		setTimeout(() => log.push('timeout 10'), 10);
+		setTimeout(() => log.push('cancelled'), 5);
+		clearTimeout(4);
+		let ticks = 0;
+		const interval = setInterval(() => {
+			log.push('tick ' + ++ticks);
+			if (ticks == 3) clearInterval(interval);
+		}, 2);`, "timers.js")
+	fatalIf(t, err)
+
+	start := time.Now()
+	fatalIf(t, loop.Run(context.Background()))
+	if elapsed := time.Since(start); elapsed < 20*time.Millisecond {
+		t.Errorf("expected Run to wait for the last timer, took %v", elapsed)
+	}
+	val, _ := ctx.RunScript("JSON.stringify(log)", "log.js")
+	log := val.String()
+	for _, order := range [][2]string{
+		{"timeout 0", "microtask"},
+		{"tick 3", "timeout 10"},
+		{"timeout 10", "timeout 20 xy"},
+	} {
+		if i, j := strings.Index(log, order[0]), strings.Index(log, order[1]); i < 0 || j < 0 || i > j {
+			t.Errorf("expected %q before %q in %s", order[0], order[1], log)
+		}
+	}
+	if strings.Contains(log, "cancelled") || strings.Contains(log, "tick 4") {
+		t.Errorf("expected cleared timers not to run, got %s", log)
+	}
+
+	_, err = ctx.RunScript("setTimeout('not a function')", "bad.js")
+	if e, ok := err.(*v8.JSError); !ok || !strings.Contains(e.Message, "TypeError") {
+		t.Errorf("expected TypeError, got %v", err)
+	}
+
+	_, err = ctx.RunScript("setTimeout(() => { throw new Error('boom') })", "throws.js")
+	fatalIf(t, err)
+	if err := loop.Run(context.Background()); err == nil || !strings.Contains(err.Error(), "boom") {
+		t.Errorf("expected the exception of the timer, got %v", err)
+	}
+}
+
+func TestEventLoopReleasesValues(t *testing.T) {
+	t.Parallel()
+
+	ctx := v8.NewContext()
+	defer ctx.Isolate().Dispose()
+	defer ctx.Close()
+	loop := v8.NewEventLoop(ctx)
+
+	before := ctx.RetainedValueCount()
+	val, err := ctx.RunScript(`
+		let ticks = 0, timeouts = 0;
+		const interval = setInterval(() => {
+			if (++ticks == 100) clearInterval(interval);
+			return {ticks};
+		}, 1);
+		(function next() {
+			if (++timeouts < 100) setTimeout(next, 1, 'arg');
+		})();`, "timers.js")
+	fatalIf(t, err)
+	val.Release()
+	fatalIf(t, loop.Run(context.Background()))
+
+	if n := ctx.RetainedValueCount() - before; n > 5 {
+		t.Errorf("expected the values of finished timers to be released, %d are retained", n)
+	}
+}
+
+func TestEventLoopEnqueue(t *testing.T) {
+	t.Parallel()
+
+	ctx := v8.NewContext()
+	defer ctx.Isolate().Dispose()
+	defer ctx.Close()
+	loop := v8.NewEventLoop(ctx)
+
+	// an idle loop returns right away
+	fatalIf(t, loop.Run(context.Background()))
+
+	// a held loop waits for tasks enqueued in the background
+	release := loop.Hold()
+	go func() {
+		time.Sleep(10 * time.Millisecond)
+		loop.Enqueue(func() error {
+			_, err := ctx.RunScript("globalThis.result = 'from Go'", "task.js")
+			return err
+		})
+		release()
+	}()
+	fatalIf(t, loop.Run(context.Background()))
+	if val, _ := ctx.RunScript("result", "result.js"); val.String() != "from Go" {
+		t.Errorf("expected the task to run, got %v", val)
+	}
+
+	taskErr := errors.New("task failed")
+	loop.Enqueue(func() error { return taskErr })
+	if err := loop.Run(context.Background()); err != taskErr {
+		t.Errorf("expected the error of the task, got %v", err)
+	}
+
+	_, err := ctx.RunScript("setInterval(() => {}, 1)", "forever.js")
+	fatalIf(t, err)
+	timeout, cancel := context.WithTimeout(context.Background(), 20*time.Millisecond)
+	defer cancel()
+	if err := loop.Run(timeout); err != context.DeadlineExceeded {
+		t.Errorf("expected the deadline to stop the loop, got %v", err)
+	}
+}
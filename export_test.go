@@ -14,6 +14,13 @@ func (i *Isolate) GetCallback(ref int) FunctionCallback {
 	return i.getCallback(ref)
 }
 
+// CallbackCount is exported for testing only.
+func (i *Isolate) CallbackCount() int {
+	i.cbMutex.RLock()
+	defer i.cbMutex.RUnlock()
+	return len(i.cbs)
+}
+
 // GetContext is exported for testing only.
 var GetContext = getContext
 
@@ -21,3 +28,37 @@ var GetContext = getContext
 func (c *Context) Ref() int {
 	return c.ref
 }
+
+// PendingScriptCount is exported for testing only.
+func (i *Isolate) PendingScriptCount() int {
+	i.releaseMutex.Lock()
+	defer i.releaseMutex.Unlock()
+	return len(i.releaseScripts)
+}
+
+// PendingInterruptCount is exported for testing only.
+func (i *Isolate) PendingInterruptCount() int {
+	interruptMutex.Lock()
+	defer interruptMutex.Unlock()
+	n := 0
+	for _, req := range interrupts {
+		if req.iso == i {
+			n++
+		}
+	}
+	return n
+}
+
+// SetCodeCache is exported for testing only.
+func (c *ScriptCache) SetCodeCache(source, origin string, data *CodeCacheData) {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	e := &scriptCacheEntry{
+		key:   scriptCacheKey{CodeCacheKey(source), origin},
+		ready: make(chan struct{}),
+		data:  data,
+	}
+	close(e.ready)
+	c.entries[e.key] = e
+	c.add(e)
+}
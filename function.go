@@ -8,6 +8,7 @@ package v8go
 import "C"
 
 import (
+	"time"
 	"unsafe"
 )
 
@@ -26,10 +27,24 @@ func (fn *Function) Call(recv Valuer, args ...Valuer) (*Value, error) {
 		}
 		argptr = (*C.ValuePtr)(unsafe.Pointer(&cArgs[0]))
 	}
+	fn.ctx.iso.releasePendingScripts()
 	rtn := C.FunctionCall(fn.ptr, recv.value().ptr, C.int(len(args)), argptr)
 	return valueResult(fn.ctx, rtn)
 }
 
+// CallWithDeadline calls the function like Call, terminating it if it is still
+// running at deadline, in which case the error is ErrDeadlineExceeded.
+func (fn *Function) CallWithDeadline(deadline time.Time, recv Valuer, args ...Valuer) (*Value, error) {
+	var val *Value
+	var err error
+	if fn.ctx.iso.withDeadline(deadline, func() {
+		val, err = fn.Call(recv, args...)
+	}) && err != nil {
+		return nil, ErrDeadlineExceeded
+	}
+	return val, err
+}
+
 // Invoke a constructor function to create an object instance.
 func (fn *Function) NewInstance(args ...Valuer) (*Object, error) {
 	var argptr *C.ValuePtr
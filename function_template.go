@@ -64,8 +64,9 @@ func NewFunctionTemplate(iso *Isolate, callback FunctionCallback) *FunctionTempl
 	cbref := iso.registerCallback(callback)
 
 	tmpl := &template{
-		ptr: C.NewFunctionTemplate(iso.ptr, C.int(cbref)),
-		iso: iso,
+		ptr:      C.NewFunctionTemplate(iso.ptr, C.int(cbref)),
+		iso:      iso,
+		callback: cbref,
 	}
 	runtime.SetFinalizer(tmpl, (*template).finalizer)
 	return &FunctionTemplate{tmpl}
@@ -74,7 +75,7 @@ func NewFunctionTemplate(iso *Isolate, callback FunctionCallback) *FunctionTempl
 // GetFunction returns an instance of this function template bound to the given context.
 func (tmpl *FunctionTemplate) GetFunction(ctx *Context) *Function {
 	rtn := C.FunctionTemplateGetFunction(tmpl.ptr, ctx.ptr)
-	runtime.KeepAlive(tmpl)
+	ctx.retainTemplate(tmpl.template)
 	val, err := valueResult(ctx, rtn)
 	if err != nil {
 		panic(err) // TODO: Consider returning the error
@@ -103,6 +104,10 @@ func goFunctionCallback(ctxref int, cbref int, thisAndArgs *C.ValuePtr, argsCoun
 	}
 
 	callbackFunc := ctx.iso.getCallback(cbref)
+	if callbackFunc == nil {
+		// a one-shot callback that has already been called
+		return nil
+	}
 	if val := callbackFunc(info); val != nil {
 		return val.ptr
 	}
@@ -6,7 +6,9 @@ package v8go_test
 
 import (
 	"fmt"
+	"runtime"
 	"testing"
+	"time"
 
 	v8 "github.com/ionos-cloud/v8go"
 )
@@ -149,6 +151,37 @@ func TestFunctionCallbackInfoThis(t *testing.T) {
 	}
 }
 
+func TestFunctionTemplateCallbackCollected(t *testing.T) {
+	t.Parallel()
+
+	iso := v8.NewIsolate()
+	defer iso.Dispose()
+	base := iso.CallbackCount()
+
+	ctx := v8.NewContext(iso)
+	for i := 0; i < 100; i++ {
+		tmpl := v8.NewFunctionTemplate(iso, func(info *v8.FunctionCallbackInfo) *v8.Value { return nil })
+		ctx.Global().Set(fmt.Sprintf("f%d", i), tmpl.GetFunction(ctx))
+	}
+	runtime.GC()
+	// the functions of the context still need their callbacks
+	if _, err := ctx.RunScript("f0(); f99()", "call.js"); err != nil {
+		t.Fatal(err)
+	}
+	if n := iso.CallbackCount() - base; n != 100 {
+		t.Errorf("expected the callbacks to be kept with the context, got %d", n)
+	}
+
+	ctx.Close()
+	for deadline := time.Now().Add(5 * time.Second); iso.CallbackCount() > base && time.Now().Before(deadline); {
+		runtime.GC()
+		time.Sleep(time.Millisecond)
+	}
+	if n := iso.CallbackCount() - base; n != 0 {
+		t.Errorf("expected the callbacks of the collected templates to be unregistered, %d left", n)
+	}
+}
+
 func ExampleFunctionTemplate() {
 	iso := v8.NewIsolate()
 	defer iso.Dispose()
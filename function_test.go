@@ -6,6 +6,7 @@ package v8go_test
 
 import (
 	"testing"
+	"time"
 
 	v8 "github.com/ionos-cloud/v8go"
 )
@@ -119,6 +120,34 @@ func TestFunctionCallError(t *testing.T) {
 	}
 }
 
+func TestFunctionCallWithDeadline(t *testing.T) {
+	t.Parallel()
+
+	ctx := v8.NewContext()
+	iso := ctx.Isolate()
+	defer iso.Dispose()
+	defer ctx.Close()
+
+	_, err := ctx.RunScript("function spin(n) { while (n--) {} return 'done' }", "script.js")
+	fatalIf(t, err)
+	spinValue, err := ctx.Global().Get("spin")
+	fatalIf(t, err)
+	fn, _ := spinValue.AsFunction()
+
+	forever, _ := v8.NewValue(iso, float64(-1))
+	if _, err := fn.CallWithDeadline(time.Now().Add(10*time.Millisecond), v8.Undefined(iso), forever); err != v8.ErrDeadlineExceeded {
+		t.Errorf("expected ErrDeadlineExceeded, got %v", err)
+	}
+	short, _ := v8.NewValue(iso, int32(10))
+	if val, err := fn.CallWithDeadline(time.Now().Add(time.Second), v8.Undefined(iso), short); err != nil || val.String() != "done" {
+		t.Errorf("expected done, got %v (%v)", val, err)
+	}
+	// a deadline in the past terminates the call as soon as it starts
+	if _, err := fn.CallWithDeadline(time.Now().Add(-time.Second), v8.Undefined(iso), forever); err != v8.ErrDeadlineExceeded {
+		t.Errorf("expected ErrDeadlineExceeded, got %v", err)
+	}
+}
+
 func TestFunctionSourceMapUrl(t *testing.T) {
 	t.Parallel()
 
@@ -0,0 +1,96 @@
+// Copyright 2023 the v8go contributors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+package v8go
+
+// HeapProfileNode is a function in the call tree of an allocation profile.
+type HeapProfileNode struct {
+	// The function name (empty string for anonymous functions.)
+	functionName string
+
+	// The resource name for script from where the function originates.
+	scriptResourceName string
+
+	// The id of the script where the function originates.
+	scriptID int
+
+	// The number of the line where the function originates.
+	lineNumber int
+
+	// The number of the column where the function originates.
+	columnNumber int
+
+	// The bytes of the sampled allocations made by the function itself.
+	selfSize uint64
+
+	// The count of the sampled allocations made by the function itself.
+	allocationCount uint64
+
+	// The children node of this node.
+	children []*HeapProfileNode
+
+	// The parent node of this node.
+	parent *HeapProfileNode
+}
+
+// Returns function name (empty string for anonymous functions.)
+func (h *HeapProfileNode) GetFunctionName() string {
+	return h.functionName
+}
+
+// Returns resource name for script from where the function originates.
+func (h *HeapProfileNode) GetScriptResourceName() string {
+	return h.scriptResourceName
+}
+
+// Returns id for script from where the function originates.
+func (h *HeapProfileNode) GetScriptID() int {
+	return h.scriptID
+}
+
+// Returns number of the line where the function originates.
+func (h *HeapProfileNode) GetLineNumber() int {
+	return h.lineNumber
+}
+
+// Returns number of the column where the function originates.
+func (h *HeapProfileNode) GetColumnNumber() int {
+	return h.columnNumber
+}
+
+// Returns the bytes of the sampled allocations made by the function itself,
+// not by the functions it calls, that are still alive.
+func (h *HeapProfileNode) GetSelfSize() uint64 {
+	return h.selfSize
+}
+
+// Returns the count of the sampled allocations made by the function itself
+// that are still alive.
+func (h *HeapProfileNode) GetAllocationCount() uint64 {
+	return h.allocationCount
+}
+
+// Returns the bytes of the sampled allocations made by the function and the
+// functions it calls.
+func (h *HeapProfileNode) GetTotalSize() uint64 {
+	total := h.selfSize
+	for _, child := range h.children {
+		total += child.GetTotalSize()
+	}
+	return total
+}
+
+// Retrieves the ancestor node, or nil if the root.
+func (h *HeapProfileNode) GetParent() *HeapProfileNode {
+	return h.parent
+}
+
+func (h *HeapProfileNode) GetChildrenCount() int {
+	return len(h.children)
+}
+
+// Retrieves a child node by index.
+func (h *HeapProfileNode) GetChild(index int) *HeapProfileNode {
+	return h.children[index]
+}
@@ -0,0 +1,146 @@
+// Copyright 2023 the v8go contributors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+package v8go
+
+/*
+#include "v8go.h"
+*/
+import "C"
+
+import (
+	"io"
+	"sync"
+	"unsafe"
+)
+
+// HeapProfiler is used to find out what the heap of an isolate retains, with
+// heap snapshots, and where its memory is allocated, with the sampling heap
+// profiler.
+type HeapProfiler struct {
+	iso *Isolate
+}
+
+// NewHeapProfiler returns the heap profiler of the isolate.
+func NewHeapProfiler(iso *Isolate) *HeapProfiler {
+	return &HeapProfiler{iso: iso}
+}
+
+// TakeHeapSnapshot takes a snapshot of the heap of the isolate and writes it
+// to w in the JSON format of .heapsnapshot files, which Chrome DevTools can
+// load. The snapshot is written in chunks as it is serialized, rather than
+// buffered whole. An error from w stops the serialization and is returned.
+func (h *HeapProfiler) TakeHeapSnapshot(w io.Writer) error {
+	if h.iso.ptr == nil {
+		panic("isolate is nil")
+	}
+	sw := &snapshotWriter{w: w}
+	ref := registerSnapshotWriter(sw)
+	defer unregisterSnapshotWriter(ref)
+	C.HeapProfilerTakeSnapshot(h.iso.ptr, C.int(ref))
+	return sw.err
+}
+
+// StartSamplingHeapProfiler starts sampling the allocations of the isolate, on
+// average once every sampleInterval bytes, recording stacks of up to
+// stackDepth frames. Sampling is cheap enough to leave on for long periods;
+// GetAllocationProfile returns what it has found so far. Zero values select
+// V8's defaults of 512 KiB and 16 frames. It returns false if sampling was
+// already started.
+func (h *HeapProfiler) StartSamplingHeapProfiler(sampleInterval uint64, stackDepth int) bool {
+	if h.iso.ptr == nil {
+		panic("isolate is nil")
+	}
+	if sampleInterval == 0 {
+		sampleInterval = 512 << 10
+	}
+	if stackDepth == 0 {
+		stackDepth = 16
+	}
+	return C.HeapProfilerStartSampling(h.iso.ptr, C.uint64_t(sampleInterval), C.int(stackDepth)) != 0
+}
+
+// StopSamplingHeapProfiler stops sampling allocations, discarding the samples.
+func (h *HeapProfiler) StopSamplingHeapProfiler() {
+	if h.iso.ptr == nil {
+		panic("isolate is nil")
+	}
+	C.HeapProfilerStopSampling(h.iso.ptr)
+}
+
+// GetAllocationProfile returns the root of the call tree of the sampled
+// allocations that are still alive, or nil if sampling has not been started.
+func (h *HeapProfiler) GetAllocationProfile() *HeapProfileNode {
+	if h.iso.ptr == nil {
+		panic("isolate is nil")
+	}
+	root := C.HeapProfilerGetAllocationProfile(h.iso.ptr)
+	if root == nil {
+		return nil
+	}
+	defer C.HeapProfileNodeDelete(root)
+	return newHeapProfileNode(root, nil)
+}
+
+func newHeapProfileNode(node *C.HeapProfileNode, parent *HeapProfileNode) *HeapProfileNode {
+	n := &HeapProfileNode{
+		functionName:       C.GoString(node.functionName),
+		scriptResourceName: C.GoString(node.scriptResourceName),
+		scriptID:           int(node.scriptId),
+		lineNumber:         int(node.lineNumber),
+		columnNumber:       int(node.columnNumber),
+		selfSize:           uint64(node.selfSize),
+		allocationCount:    uint64(node.allocationCount),
+		parent:             parent,
+	}
+
+	if node.childrenCount > 0 {
+		n.children = make([]*HeapProfileNode, node.childrenCount)
+		for i, child := range unsafe.Slice(node.children, node.childrenCount) {
+			n.children[i] = newHeapProfileNode(child, n)
+		}
+	}
+
+	return n
+}
+
+type snapshotWriter struct {
+	w   io.Writer
+	err error
+}
+
+var (
+	snapshotWriterMutex sync.Mutex
+	snapshotWriterSeq   int
+	snapshotWriters     = make(map[int]*snapshotWriter)
+)
+
+func registerSnapshotWriter(sw *snapshotWriter) int {
+	snapshotWriterMutex.Lock()
+	defer snapshotWriterMutex.Unlock()
+	snapshotWriterSeq++
+	snapshotWriters[snapshotWriterSeq] = sw
+	return snapshotWriterSeq
+}
+
+func unregisterSnapshotWriter(ref int) {
+	snapshotWriterMutex.Lock()
+	defer snapshotWriterMutex.Unlock()
+	delete(snapshotWriters, ref)
+}
+
+//export goWriteHeapSnapshot
+func goWriteHeapSnapshot(ref int, data unsafe.Pointer, size int) int {
+	snapshotWriterMutex.Lock()
+	sw := snapshotWriters[ref]
+	snapshotWriterMutex.Unlock()
+	if sw == nil || sw.err != nil {
+		return 0
+	}
+	if _, err := sw.w.Write(unsafe.Slice((*byte)(data), size)); err != nil {
+		sw.err = err
+		return 0
+	}
+	return 1
+}
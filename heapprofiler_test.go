@@ -0,0 +1,122 @@
+// Copyright 2023 the v8go contributors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+package v8go_test
+
+import (
+	"bytes"
+	"encoding/json"
+	"errors"
+	"testing"
+
+	v8 "github.com/ionos-cloud/v8go"
+)
+
+type chunkWriter struct {
+	bytes.Buffer
+	writes int
+	err    error
+}
+
+func (w *chunkWriter) Write(p []byte) (int, error) {
+	w.writes++
+	if w.err != nil {
+		return 0, w.err
+	}
+	return w.Buffer.Write(p)
+}
+
+func TestHeapProfilerTakeHeapSnapshot(t *testing.T) {
+	t.Parallel()
+
+	ctx := v8.NewContext()
+	iso := ctx.Isolate()
+	defer iso.Dispose()
+	defer ctx.Close()
+	_, err := ctx.RunScript("class LeakyThing {}; globalThis.leak = new LeakyThing()", "leak.js")
+	fatalIf(t, err)
+
+	profiler := v8.NewHeapProfiler(iso)
+	w := &chunkWriter{}
+	fatalIf(t, profiler.TakeHeapSnapshot(w))
+	if w.writes < 2 {
+		t.Errorf("expected the snapshot to be streamed in chunks, got %d writes", w.writes)
+	}
+	if !json.Valid(w.Bytes()) {
+		t.Fatal("expected the snapshot to be JSON")
+	}
+	if !bytes.Contains(w.Bytes(), []byte("LeakyThing")) {
+		t.Error("expected the snapshot to contain the retained object")
+	}
+
+	writeErr := errors.New("disk full")
+	w = &chunkWriter{err: writeErr}
+	if err := profiler.TakeHeapSnapshot(w); err != writeErr {
+		t.Errorf("expected the error of the writer, got %v", err)
+	}
+	if w.writes != 1 {
+		t.Errorf("expected the snapshot to stop at the failed write, got %d writes", w.writes)
+	}
+}
+
+func TestHeapProfilerSampling(t *testing.T) {
+	t.Parallel()
+
+	ctx := v8.NewContext()
+	iso := ctx.Isolate()
+	defer iso.Dispose()
+	defer ctx.Close()
+
+	profiler := v8.NewHeapProfiler(iso)
+	if profiler.GetAllocationProfile() != nil {
+		t.Error("expected no allocation profile before sampling")
+	}
+	if !profiler.StartSamplingHeapProfiler(1024, 0) {
+		t.Fatal("expected sampling to start")
+	}
+	if profiler.StartSamplingHeapProfiler(1024, 0) {
+		t.Error("expected sampling not to start twice")
+	}
+	defer profiler.StopSamplingHeapProfiler()
+
+	_, err := ctx.RunScript(`
+		globalThis.retained = [];
+		function allocate() {
+			for (let i = 0; i < 1000; i++) retained.push(new Array(100).fill(i));
+		}
+		allocate();`, "allocate.js")
+	fatalIf(t, err)
+
+	root := profiler.GetAllocationProfile()
+	if root == nil {
+		t.Fatal("expected an allocation profile")
+	}
+	var found *v8.HeapProfileNode
+	var walk func(n *v8.HeapProfileNode)
+	walk = func(n *v8.HeapProfileNode) {
+		if n.GetFunctionName() == "allocate" {
+			found = n
+		}
+		for i := 0; i < n.GetChildrenCount(); i++ {
+			if n.GetChild(i).GetParent() != n {
+				t.Error("expected children to point to their parent")
+			}
+			walk(n.GetChild(i))
+		}
+	}
+	walk(root)
+	if found == nil {
+		t.Fatal("expected the allocating function in the profile")
+	}
+	if found.GetScriptResourceName() != "allocate.js" || found.GetLineNumber() != 3 {
+		t.Errorf("expected allocate.js:3, got %s:%d", found.GetScriptResourceName(), found.GetLineNumber())
+	}
+	if found.GetSelfSize() < 100<<10 || found.GetAllocationCount() == 0 {
+		t.Errorf("expected the retained arrays to be sampled, got %d bytes in %d allocations",
+			found.GetSelfSize(), found.GetAllocationCount())
+	}
+	if root.GetTotalSize() < found.GetSelfSize() {
+		t.Errorf("expected the total size of the root to include all nodes")
+	}
+}
@@ -0,0 +1,204 @@
+// Copyright 2023 the v8go contributors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+package v8go
+
+// #include "v8go.h"
+import "C"
+
+import (
+	"sync"
+	"sync/atomic"
+	"time"
+)
+
+// Interrupt is passed to the callback of Isolate.RequestInterrupt while the
+// interrupted JavaScript is paused.
+type Interrupt struct {
+	iso *Isolate
+}
+
+var (
+	interruptMutex sync.Mutex
+	interrupts     = make(map[int]*interruptRequest)
+	interruptSeq   = 0
+)
+
+type interruptRequest struct {
+	iso *Isolate
+	cb  func(*Interrupt)
+}
+
+// RequestInterrupt asks the isolate to call cb at the next safe point of the
+// JavaScript it is running, from the goroutine running it, pausing the script
+// until cb returns. If no JavaScript is running, cb is called as soon as
+// JavaScript runs in the isolate again. cb must not call into the isolate
+// itself, but it may call Interrupt.Yield to let other goroutines use it.
+// RequestInterrupt is safe to call from any goroutine.
+func (i *Isolate) RequestInterrupt(cb func(*Interrupt)) {
+	interruptMutex.Lock()
+	interruptSeq++
+	ref := interruptSeq
+	interrupts[ref] = &interruptRequest{i, cb}
+	interruptMutex.Unlock()
+	C.IsolateRequestInterrupt(i.ptr, C.int(ref))
+}
+
+// Yield releases the isolate while wait runs, so that other goroutines can
+// call into it in the meantime, then resumes the interrupted JavaScript where
+// it was paused. Unlike TerminateExecution, this pauses a long-running script
+// without losing its state.
+//
+// Yield refuses to release an isolate held by a call that may terminate it,
+// such as Context.RunScriptWithTimeout or Promise.Await with a cancellable
+// context, as the termination would otherwise hit the JavaScript of other
+// goroutines: it then returns false without calling wait, and the
+// interrupted JavaScript carries on.
+func (in *Interrupt) Yield(wait func()) bool {
+	if atomic.LoadInt32(&in.iso.terminable) > 0 {
+		return false
+	}
+	unlocker := C.IsolateYield(in.iso.ptr)
+	defer C.IsolateResume(unlocker)
+	wait()
+	return true
+}
+
+// dropInterrupts forgets the requests that the disposed isolate will never
+// serve.
+func (i *Isolate) dropInterrupts() {
+	interruptMutex.Lock()
+	defer interruptMutex.Unlock()
+	for ref, req := range interrupts {
+		if req.iso == i {
+			delete(interrupts, ref)
+		}
+	}
+}
+
+//export goInterrupt
+func goInterrupt(ref int) {
+	interruptMutex.Lock()
+	req := interrupts[ref]
+	delete(interrupts, ref)
+	interruptMutex.Unlock()
+	if req != nil {
+		req.cb(&Interrupt{req.iso})
+	}
+}
+
+// TimeSlicer shares an isolate fairly between the goroutines calling into it
+// through Run, in slices of time: when a goroutine has held the isolate for a
+// slice while others are waiting for it, its JavaScript is paused at the next
+// safe point and the isolate goes to the goroutine that has waited the
+// longest. The paused JavaScript resumes once its goroutine's turn comes
+// again.
+type TimeSlicer struct {
+	iso   *Isolate
+	slice time.Duration
+
+	mu      sync.Mutex
+	held    bool
+	waiters []chan struct{}
+	owner   *sliceTurn
+}
+
+type sliceTurn struct {
+	start time.Time
+	used  time.Duration
+	timer *time.Timer
+}
+
+// NewTimeSlicer creates a TimeSlicer for the isolate, with slices of the
+// given duration.
+func NewTimeSlicer(iso *Isolate, slice time.Duration) *TimeSlicer {
+	return &TimeSlicer{iso: iso, slice: slice}
+}
+
+// Run waits for its turn, then runs fn, which calls into the isolate, sharing
+// the isolate with the other calls to Run. It returns the time fn held the
+// isolate, not counting the time it was paused, to account for the use of
+// the isolate by each of its users.
+func (s *TimeSlicer) Run(fn func()) time.Duration {
+	s.acquire()
+	turn := &sliceTurn{start: time.Now()}
+	s.mu.Lock()
+	s.owner = turn
+	turn.timer = time.AfterFunc(s.slice, func() { s.expire(turn) })
+	s.mu.Unlock()
+
+	fn()
+
+	s.mu.Lock()
+	s.owner = nil
+	turn.timer.Stop()
+	turn.used += time.Since(turn.start)
+	s.mu.Unlock()
+	s.release()
+	return turn.used
+}
+
+// expire ends the slice of turn, pausing its JavaScript if another goroutine
+// is waiting for the isolate.
+func (s *TimeSlicer) expire(turn *sliceTurn) {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	if s.owner != turn {
+		return
+	}
+	if len(s.waiters) == 0 {
+		turn.timer.Reset(s.slice)
+		return
+	}
+	s.iso.RequestInterrupt(func(in *Interrupt) {
+		s.mu.Lock()
+		// the interrupt may come after the turn has ended, in the
+		// JavaScript of another turn
+		if s.owner != turn {
+			s.mu.Unlock()
+			return
+		}
+		s.owner = nil
+		turn.used += time.Since(turn.start)
+		s.mu.Unlock()
+
+		// a call with a deadline keeps the isolate until it returns
+		in.Yield(func() {
+			s.release()
+			s.acquire()
+		})
+
+		s.mu.Lock()
+		s.owner = turn
+		turn.start = time.Now()
+		turn.timer.Reset(s.slice)
+		s.mu.Unlock()
+	})
+}
+
+func (s *TimeSlicer) acquire() {
+	s.mu.Lock()
+	if !s.held {
+		s.held = true
+		s.mu.Unlock()
+		return
+	}
+	turn := make(chan struct{})
+	s.waiters = append(s.waiters, turn)
+	s.mu.Unlock()
+	<-turn
+}
+
+// release hands the isolate to the goroutine that has waited the longest.
+func (s *TimeSlicer) release() {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	if len(s.waiters) == 0 {
+		s.held = false
+		return
+	}
+	next := s.waiters[0]
+	s.waiters = s.waiters[1:]
+	close(next)
+}
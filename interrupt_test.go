@@ -0,0 +1,150 @@
+// Copyright 2023 the v8go contributors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+package v8go_test
+
+import (
+	"sync"
+	"testing"
+	"time"
+
+	v8 "github.com/ionos-cloud/v8go"
+)
+
+func TestIsolateRequestInterrupt(t *testing.T) {
+	t.Parallel()
+
+	ctx := v8.NewContext()
+	defer ctx.Isolate().Dispose()
+	defer ctx.Close()
+
+	done := make(chan *v8.Value)
+	go func() {
+		val, err := ctx.RunScript(`
+			let spins = 0;
+			while (!globalThis.stop) { spins++ }
+			'stopped'`, "spin.js")
+		if err != nil {
+			t.Error(err)
+		}
+		done <- val
+	}()
+
+	// the script is paused at a safe point while another goroutine uses the
+	// isolate, then resumes where it was
+	time.Sleep(10 * time.Millisecond)
+	ctx.Isolate().RequestInterrupt(func(in *v8.Interrupt) {
+		in.Yield(func() {
+			ran := make(chan error)
+			go func() {
+				_, err := ctx.RunScript("globalThis.stop = true", "stop.js")
+				ran <- err
+			}()
+			if err := <-ran; err != nil {
+				t.Error(err)
+			}
+		})
+	})
+
+	select {
+	case val := <-done:
+		if val.String() != "stopped" {
+			t.Errorf("expected the script to resume, got %v", val)
+		}
+	case <-time.After(5 * time.Second):
+		t.Fatal("expected the interrupt to stop the script")
+	}
+}
+
+func TestInterruptYieldWithDeadline(t *testing.T) {
+	t.Parallel()
+
+	ctx := v8.NewContext()
+	defer ctx.Isolate().Dispose()
+	defer ctx.Close()
+
+	// the isolate is not released while a deadline may terminate its holder
+	yielded := make(chan bool, 1)
+	go func() {
+		time.Sleep(10 * time.Millisecond)
+		ctx.Isolate().RequestInterrupt(func(in *v8.Interrupt) {
+			yielded <- in.Yield(func() { t.Error("unexpected call of wait") })
+		})
+	}()
+	_, err := ctx.RunScriptWithTimeout("while (true) {}", "spin.js", 100*time.Millisecond)
+	if err != v8.ErrDeadlineExceeded {
+		t.Errorf("expected ErrDeadlineExceeded, got %v", err)
+	}
+	select {
+	case ok := <-yielded:
+		if ok {
+			t.Error("expected Yield to refuse under a deadline")
+		}
+	default:
+		t.Error("expected the interrupt to run")
+	}
+}
+
+func TestIsolateDisposeDropsInterrupts(t *testing.T) {
+	t.Parallel()
+
+	iso := v8.NewIsolate()
+	iso.RequestInterrupt(func(in *v8.Interrupt) {
+		t.Error("unexpected interrupt")
+	})
+	if n := iso.PendingInterruptCount(); n != 1 {
+		t.Errorf("expected a pending interrupt, got %d", n)
+	}
+	iso.Dispose()
+	if n := iso.PendingInterruptCount(); n != 0 {
+		t.Errorf("expected Dispose to drop the pending interrupts, %d left", n)
+	}
+}
+
+func TestTimeSlicer(t *testing.T) {
+	t.Parallel()
+
+	ctx := v8.NewContext()
+	defer ctx.Isolate().Dispose()
+	defer ctx.Close()
+	slicer := v8.NewTimeSlicer(ctx.Isolate(), 5*time.Millisecond)
+
+	const work = 100 * time.Millisecond
+	var wg sync.WaitGroup
+	used := make([]time.Duration, 2)
+	finished := make([]time.Time, 2)
+	for i := range used {
+		wg.Add(1)
+		go func(i int) {
+			defer wg.Done()
+			used[i] = slicer.Run(func() {
+				// spin for 100ms of running time, not counting pauses
+				_, err := ctx.RunScript(`{
+					let last = Date.now(), ran = 0;
+					while (ran < 100) {
+						const now = Date.now();
+						if (now - last < 2) ran += now - last;
+						last = now;
+					}
+				}`, "busy.js")
+				if err != nil {
+					t.Error(err)
+				}
+			})
+			finished[i] = time.Now()
+		}(i)
+	}
+	start := time.Now()
+	wg.Wait()
+
+	// the tenants take turns, so both take about twice as long as on their own
+	for i, u := range used {
+		if u < work*9/10 {
+			t.Errorf("expected tenant %d to use the isolate for about %v, got %v", i, work, u)
+		}
+		if elapsed := finished[i].Sub(start); elapsed < work*3/2 {
+			t.Errorf("expected tenant %d to share the isolate, finished after %v", i, elapsed)
+		}
+	}
+}
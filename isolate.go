@@ -10,6 +10,7 @@ import "C"
 
 import (
 	"sync"
+	"time"
 	"unsafe"
 )
 
@@ -25,6 +26,25 @@ type Isolate struct {
 	cbSeq   int
 	cbs     map[int]FunctionCallback
 
+	rejectCallback PromiseRejectCallback
+
+	// scripts garbage collected by Go, to be released by the next
+	// compilation rather than from the finalizer, which must not wait for
+	// the isolate to be unlocked
+	releaseMutex   sync.Mutex
+	releaseScripts []C.UnboundScriptPtr
+
+	// closed when a promise is settled from Go, see Promise.Await
+	settleMutex sync.Mutex
+	settled     chan struct{}
+
+	// guards the GC events recorded by the isolate, see StartGCTracking
+	gcMutex sync.Mutex
+
+	// the number of calls holding the isolate that may terminate it, see
+	// withDeadline, Promise.Await and Interrupt.Yield
+	terminable int32
+
 	null      *Value
 	undefined *Value
 }
@@ -42,6 +62,47 @@ type HeapStatistics struct {
 	PeakMallocedMemory       uint64
 	NumberOfNativeContexts   uint64
 	NumberOfDetachedContexts uint64
+
+	// ArrayBufferAllocatedBytes is the memory currently held by the
+	// isolate's ArrayBuffers and ArrayBufferAllocatedPeak the most it has
+	// held at once.
+	ArrayBufferAllocatedBytes uint64
+	ArrayBufferAllocatedPeak  uint64
+	// ArrayBufferPooledBytes is the memory of freed buffers kept for reuse
+	// when ArrayBufferAllocator.Pooling is set.
+	ArrayBufferPooledBytes uint64
+	// ArrayBufferFailedAllocations counts the allocations refused because
+	// they would have exceeded ArrayBufferAllocator.MaxBytes.
+	ArrayBufferFailedAllocations uint64
+}
+
+type isolateOptions struct {
+	arrayBufferMaxBytes uint64
+	arrayBufferPooling  bool
+}
+
+// IsolateOption sets options such as the ArrayBufferAllocator to NewIsolate.
+type IsolateOption interface {
+	applyIsolate(*isolateOptions)
+}
+
+// ArrayBufferAllocator configures how an isolate allocates the memory of its
+// ArrayBuffers. Every isolate accounts for that memory separately, reported by
+// GetHeapStatistics.
+type ArrayBufferAllocator struct {
+	// MaxBytes caps the memory held by the isolate's ArrayBuffers at once.
+	// Allocations beyond it fail with a RangeError in JavaScript, and an
+	// error from NewArrayBuffer, rather than exhausting the memory of the
+	// process. Zero means no limit.
+	MaxBytes uint64
+	// Pooling keeps freed buffers of up to 64 KiB, rounded up to a power of
+	// two, for reuse by later allocations of the same size class.
+	Pooling bool
+}
+
+func (a ArrayBufferAllocator) applyIsolate(opts *isolateOptions) {
+	opts.arrayBufferMaxBytes = a.MaxBytes
+	opts.arrayBufferPooling = a.Pooling
 }
 
 // NewIsolate creates a new V8 isolate. Only one thread may access
@@ -51,10 +112,21 @@ type HeapStatistics struct {
 // by calling iso.Dispose().
 // An *Isolate can be used as a v8go.ContextOption to create a new
 // Context, rather than creating a new default Isolate.
-func NewIsolate() *Isolate {
+func NewIsolate(opt ...IsolateOption) *Isolate {
 	initializeIfNecessary()
+	opts := isolateOptions{}
+	for _, o := range opt {
+		if o != nil {
+			o.applyIsolate(&opts)
+		}
+	}
+	var cOptions C.IsolateOptions
+	cOptions.arrayBufferMaxBytes = C.size_t(opts.arrayBufferMaxBytes)
+	if opts.arrayBufferPooling {
+		cOptions.arrayBufferPooling = 1
+	}
 	iso := &Isolate{
-		ptr: C.NewIsolate(),
+		ptr: C.NewIsolate(cOptions),
 		cbs: make(map[int]FunctionCallback),
 	}
 	iso.null = newValueNull(iso)
@@ -68,6 +140,13 @@ func (i *Isolate) TerminateExecution() {
 	C.IsolateTerminateExecution(i.ptr)
 }
 
+// CancelTerminateExecution cancels a termination requested with
+// TerminateExecution that has not been acted on yet, which would otherwise
+// terminate the next call into the isolate.
+func (i *Isolate) CancelTerminateExecution() {
+	C.IsolateCancelTerminateExecution(i.ptr)
+}
+
 // IsExecutionTerminating returns whether V8 is currently terminating
 // Javascript execution. If true, there are still JavaScript frames
 // on the stack and the termination exception is still active.
@@ -79,6 +158,10 @@ type CompileOptions struct {
 	CachedData *CompilerCachedData
 
 	Mode CompileMode
+
+	// CacheStore, if set, is looked up for a code cache of the source, and
+	// filled with one when none is found or V8 rejects it.
+	CacheStore CodeCacheStore
 }
 
 // CompileUnboundScript will create an UnboundScript (i.e. context-indepdent)
@@ -87,6 +170,10 @@ type CompileOptions struct {
 // that code cache.
 // error will be of type `JSError` if not nil.
 func (i *Isolate) CompileUnboundScript(source, origin string, opts CompileOptions) (*UnboundScript, error) {
+	i.releasePendingScripts()
+	if opts.CacheStore != nil {
+		return i.compileUnboundScriptCached(source, origin, opts)
+	}
 	cSource := C.CString(source)
 	cOrigin := C.CString(origin)
 	defer C.free(unsafe.Pointer(cSource))
@@ -113,10 +200,7 @@ func (i *Isolate) CompileUnboundScript(source, origin string, opts CompileOption
 	if opts.CachedData != nil {
 		opts.CachedData.Rejected = int(rtn.cachedDataRejected) == 1
 	}
-	return &UnboundScript{
-		ptr: rtn.ptr,
-		iso: i,
-	}, nil
+	return newUnboundScript(i, rtn.ptr), nil
 }
 
 // GetHeapStatistics returns heap statistics for an isolate.
@@ -135,16 +219,68 @@ func (i *Isolate) GetHeapStatistics() HeapStatistics {
 		PeakMallocedMemory:       uint64(hs.peak_malloced_memory),
 		NumberOfNativeContexts:   uint64(hs.number_of_native_contexts),
 		NumberOfDetachedContexts: uint64(hs.number_of_detached_contexts),
+
+		ArrayBufferAllocatedBytes:    uint64(hs.array_buffer_allocated_bytes),
+		ArrayBufferAllocatedPeak:     uint64(hs.array_buffer_peak_bytes),
+		ArrayBufferPooledBytes:       uint64(hs.array_buffer_pooled_bytes),
+		ArrayBufferFailedAllocations: uint64(hs.array_buffer_failed_allocations),
+	}
+}
+
+// ExecutionStatistics is the time spent running in an isolate, or in one of
+// its contexts, to account for its use by each tenant. The counters only ever
+// increase, so usage over a period is the difference of two readings.
+type ExecutionStatistics struct {
+	// CPUTime is the CPU time of the calls from Go that run JavaScript, and
+	// WallTime the time elapsed during them. Time a script spends paused by
+	// Interrupt.Yield is not counted.
+	CPUTime  time.Duration
+	WallTime time.Duration
+	// Entries counts the calls from Go that run JavaScript: running scripts,
+	// calling functions, evaluating modules and running microtasks. Other
+	// calls, such as reading a value, are not counted, to keep them cheap.
+	// The calls made from Go callbacks are part of the call that ran the
+	// callback.
+	Entries uint64
+	// CallbackTime is the wall time spent in the Go callbacks called by
+	// JavaScript, which is included in CPUTime and WallTime, and Callbacks
+	// counts them.
+	CallbackTime time.Duration
+	Callbacks    uint64
+}
+
+func newExecutionStatistics(u C.ExecutionUsage) ExecutionStatistics {
+	return ExecutionStatistics{
+		CPUTime:      time.Duration(u.cpu_ns),
+		WallTime:     time.Duration(u.wall_ns),
+		Entries:      uint64(u.entries),
+		CallbackTime: time.Duration(u.callback_ns),
+		Callbacks:    uint64(u.callbacks),
 	}
 }
 
+// GetExecutionStatistics returns the time spent running in the isolate, in
+// all of its contexts. The counters are always kept; reading them costs no
+// more than reading a few atomic integers.
+func (i *Isolate) GetExecutionStatistics() ExecutionStatistics {
+	return newExecutionStatistics(C.IsolateGetExecutionUsage(i.ptr))
+}
+
 // Dispose will dispose the Isolate VM; subsequent calls will panic.
 func (i *Isolate) Dispose() {
 	if i.ptr == nil {
 		return
 	}
+	i.gcMutex.Lock()
 	C.IsolateDispose(i.ptr)
 	i.ptr = nil
+	i.gcMutex.Unlock()
+
+	i.releaseMutex.Lock()
+	i.releaseScripts = nil
+	i.releaseMutex.Unlock()
+
+	i.dropInterrupts()
 }
 
 // ThrowException schedules an exception to be thrown when returning to
@@ -165,6 +301,26 @@ func (i *Isolate) Close() {
 	i.Dispose()
 }
 
+// settledFromGo returns a channel closed the next time a promise of the
+// isolate is settled from Go.
+func (i *Isolate) settledFromGo() <-chan struct{} {
+	i.settleMutex.Lock()
+	defer i.settleMutex.Unlock()
+	if i.settled == nil {
+		i.settled = make(chan struct{})
+	}
+	return i.settled
+}
+
+func (i *Isolate) notifySettled() {
+	i.settleMutex.Lock()
+	defer i.settleMutex.Unlock()
+	if i.settled != nil {
+		close(i.settled)
+		i.settled = nil
+	}
+}
+
 func (i *Isolate) apply(opts *contextOptions) {
 	opts.iso = i
 }
@@ -178,6 +334,33 @@ func (i *Isolate) registerCallback(cb FunctionCallback) int {
 	return ref
 }
 
+// registerOneShotCallbacks registers callbacks of which at most one is ever
+// called, once, such as the reactions of a promise: all of them are
+// unregistered when the first one is called.
+func (i *Isolate) registerOneShotCallbacks(cbs ...FunctionCallback) []int {
+	refs := make([]int, len(cbs))
+	i.cbMutex.Lock()
+	defer i.cbMutex.Unlock()
+	for n, cb := range cbs {
+		cb := cb
+		i.cbSeq++
+		refs[n] = i.cbSeq
+		i.cbs[refs[n]] = func(info *FunctionCallbackInfo) *Value {
+			i.unregisterCallbacks(refs...)
+			return cb(info)
+		}
+	}
+	return refs
+}
+
+func (i *Isolate) unregisterCallbacks(refs ...int) {
+	i.cbMutex.Lock()
+	defer i.cbMutex.Unlock()
+	for _, ref := range refs {
+		delete(i.cbs, ref)
+	}
+}
+
 func (i *Isolate) getCallback(ref int) FunctionCallback {
 	i.cbMutex.RLock()
 	defer i.cbMutex.RUnlock()
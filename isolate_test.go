@@ -5,11 +5,14 @@
 package v8go_test
 
 import (
+	"bytes"
 	"encoding/json"
 	"fmt"
 	"math/rand"
+	"runtime"
 	"strings"
 	"testing"
+	"time"
 
 	v8 "github.com/ionos-cloud/v8go"
 )
@@ -122,6 +125,39 @@ func TestIsolateCompileUnboundScript_CachedDataRejected(t *testing.T) {
 	}
 }
 
+func TestIsolateCompileUnboundScript_CodeCacheData(t *testing.T) {
+	s := "function foo() { return 'bar'; }; foo()"
+	i1 := v8.NewIsolate()
+	defer i1.Dispose()
+	us, err := i1.CompileUnboundScript(s, "script.js", v8.CompileOptions{})
+	fatalIf(t, err)
+	data := us.CreateCodeCacheData()
+	defer data.Free()
+	if !bytes.Equal(data.Bytes(), us.CreateCodeCache().Bytes) {
+		t.Error("expected the same code cache as CreateCodeCache")
+	}
+
+	// the C memory is consumed in place
+	i2 := v8.NewIsolate()
+	defer i2.Dispose()
+	opts := v8.CompileOptions{CachedData: &v8.CompilerCachedData{Bytes: data.Bytes()}}
+	us, err = i2.CompileUnboundScript(s, "script.js", opts)
+	fatalIf(t, err)
+	if opts.CachedData.Rejected {
+		t.Error("expected code cache to be accepted")
+	}
+	ctx := v8.NewContext(i2)
+	defer ctx.Close()
+	if val, _ := us.Run(ctx); val.String() != "bar" {
+		t.Errorf("invalid value returned, expected bar got %v", val)
+	}
+
+	data.Free()
+	if data.Bytes() != nil {
+		t.Error("expected no bytes after Free")
+	}
+}
+
 func TestIsolateCompileUnboundScript_InvalidOptions(t *testing.T) {
 	iso := v8.NewIsolate()
 	defer iso.Dispose()
@@ -159,6 +195,55 @@ func TestIsolateGetHeapStatistics(t *testing.T) {
 	}
 }
 
+func TestIsolateGetExecutionStatistics(t *testing.T) {
+	t.Parallel()
+	iso := v8.NewIsolate()
+	defer iso.Dispose()
+	busy := v8.NewContext(iso)
+	defer busy.Close()
+	idle := v8.NewContext(iso)
+	defer idle.Close()
+
+	sleep := v8.NewFunctionTemplate(iso, func(*v8.FunctionCallbackInfo) *v8.Value {
+		time.Sleep(20 * time.Millisecond)
+		return nil
+	})
+	fatalIf(t, busy.Global().Set("sleep", sleep.GetFunction(busy)))
+	before := busy.GetExecutionStatistics()
+	_, err := busy.RunScript(`
+		// Date.now() is in whole milliseconds, spin for more than 30ms
+		const start = Date.now();
+		while (Date.now() - start <= 30) {}
+		sleep();`, "busy.js")
+	fatalIf(t, err)
+
+	after := busy.GetExecutionStatistics()
+	if n := after.Entries - before.Entries; n != 1 {
+		t.Errorf("expected 1 entry, got %d", n)
+	}
+	if n := after.Callbacks - before.Callbacks; n != 1 {
+		t.Errorf("expected 1 callback, got %d", n)
+	}
+	if d := after.CallbackTime - before.CallbackTime; d < 20*time.Millisecond {
+		t.Errorf("expected the callback to take 20ms, got %v", d)
+	}
+	cpu, wall := after.CPUTime-before.CPUTime, after.WallTime-before.WallTime
+	// the thread may be preempted by the other tests running in parallel
+	if cpu < 15*time.Millisecond || wall < 50*time.Millisecond {
+		t.Errorf("expected about 30ms of CPU time in 50ms, got %v in %v", cpu, wall)
+	}
+	if wall-cpu < 15*time.Millisecond {
+		t.Errorf("expected the sleep not to use CPU time, got %v in %v", cpu, wall)
+	}
+
+	if s := idle.GetExecutionStatistics(); s != (v8.ExecutionStatistics{}) {
+		t.Errorf("expected an unused context to have no statistics, got %+v", s)
+	}
+	if s := iso.GetExecutionStatistics(); s.WallTime < after.WallTime || s.Entries < after.Entries {
+		t.Errorf("expected the isolate to count the time of its contexts, got %+v", s)
+	}
+}
+
 func TestCallbackRegistry(t *testing.T) {
 	t.Parallel()
 
@@ -199,6 +284,48 @@ func TestIsolateDispose(t *testing.T) {
 	}
 }
 
+func TestIsolateArrayBufferAllocator(t *testing.T) {
+	t.Parallel()
+
+	iso := v8.NewIsolate(v8.ArrayBufferAllocator{MaxBytes: 1 << 20, Pooling: true})
+	defer iso.Dispose()
+	ctx := v8.NewContext(iso)
+	defer ctx.Close()
+
+	val, err := ctx.RunScript("var buf = new ArrayBuffer(1000); buf", "alloc.js")
+	fatalIf(t, err)
+	if hs := iso.GetHeapStatistics(); hs.ArrayBufferAllocatedBytes != 1000 || hs.ArrayBufferAllocatedPeak != 1000 {
+		t.Errorf("expected 1000 bytes allocated, got %d with peak %d", hs.ArrayBufferAllocatedBytes, hs.ArrayBufferAllocatedPeak)
+	}
+
+	// moving the buffer out and dropping it frees its memory into the pool
+	s, err := v8.SerializeWithTransfer(val, val)
+	fatalIf(t, err)
+	s.Release()
+	if hs := iso.GetHeapStatistics(); hs.ArrayBufferAllocatedBytes != 0 || hs.ArrayBufferPooledBytes != 1024 {
+		t.Errorf("expected the freed buffer to be pooled, got %d allocated and %d pooled", hs.ArrayBufferAllocatedBytes, hs.ArrayBufferPooledBytes)
+	}
+	zeroed, err := ctx.RunScript("new Uint8Array(new ArrayBuffer(1000)).every(b => b === 0)", "reuse.js")
+	fatalIf(t, err)
+	if !zeroed.Boolean() {
+		t.Error("expected a reused buffer to be zero-filled")
+	}
+	if hs := iso.GetHeapStatistics(); hs.ArrayBufferPooledBytes != 0 {
+		t.Errorf("expected the pooled buffer to be reused, got %d pooled", hs.ArrayBufferPooledBytes)
+	}
+
+	_, err = ctx.RunScript("new ArrayBuffer(2 << 20)", "limit.js")
+	if err == nil || !strings.Contains(err.Error(), "RangeError") {
+		t.Errorf("expected RangeError allocating past the limit, got %v", err)
+	}
+	if _, err := v8.NewArrayBuffer(ctx, 2<<20); err == nil {
+		t.Error("expected error allocating past the limit")
+	}
+	if hs := iso.GetHeapStatistics(); hs.ArrayBufferFailedAllocations == 0 {
+		t.Error("expected failed allocations to be counted")
+	}
+}
+
 func TestIsolateThrowException(t *testing.T) {
 	t.Parallel()
 	iso := v8.NewIsolate()
@@ -277,6 +404,49 @@ func BenchmarkIsolateInitAndRun(b *testing.B) {
 	}
 }
 
+// BenchmarkExecutionStatistics shows the cost of the accounting: the calls
+// that run JavaScript read the clocks, the accessors do not.
+func BenchmarkExecutionStatistics(b *testing.B) {
+	for _, bench := range []struct {
+		name string
+		call func(*v8.Function, *v8.Value)
+	}{
+		{"Accessor", func(fn *v8.Function, this *v8.Value) { fn.IsFunction() }},
+		{"Call", func(fn *v8.Function, this *v8.Value) {
+			res, _ := fn.Call(this)
+			res.Release()
+		}},
+	} {
+		b.Run(bench.name, func(b *testing.B) {
+			// entering an isolate from the main thread is much slower, as V8
+			// looks up the stack of the thread each time, so the calls are
+			// made from another locked thread while this one is held
+			runtime.LockOSThread()
+			defer runtime.UnlockOSThread()
+			done := make(chan struct{})
+			go func() {
+				defer close(done)
+				runtime.LockOSThread()
+				defer runtime.UnlockOSThread()
+				iso := v8.NewIsolate()
+				defer iso.Dispose()
+				ctx := v8.NewContext(iso)
+				defer ctx.Close()
+				val, _ := ctx.RunScript("() => 42", "fn.js")
+				fn, _ := val.AsFunction()
+				this := v8.Undefined(iso)
+
+				b.ResetTimer()
+				for n := 0; n < b.N; n++ {
+					bench.call(fn, this)
+				}
+				b.StopTimer()
+			}()
+			<-done
+		})
+	}
+}
+
 const script = `
 	const process = (record) => {
 		const res = [];
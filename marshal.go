@@ -0,0 +1,82 @@
+// Copyright 2023 the v8go contributors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+package v8go
+
+// #include <stdlib.h>
+// #include "v8go.h"
+import "C"
+
+import (
+	"errors"
+	"unsafe"
+)
+
+// Marshal builds a JavaScript value from a Go value in a single call into V8,
+// without going through JSON. Supported Go types are:
+//
+//	nil, nil pointers, maps and slices -> null
+//	bool -> Boolean
+//	string -> String
+//	integers and floats -> Number
+//	*big.Int -> BigInt
+//	[]byte -> Uint8Array
+//	[]int8, []uint16, []int16, []uint32, []int32 -> the matching typed array
+//	[]float32, []float64 -> Float32Array, Float64Array
+//	other slices and arrays -> Array
+//	maps with string or integer keys -> Object
+//	structs -> Object, with field names following the `json` struct tag
+//	Valuer -> the value itself, which must belong to the same isolate
+//
+// Unlike NewValue, integers are converted to Numbers so that the result is the
+// same as JSONParse of the encoding/json output, with two exceptions: []byte
+// and the slices of the numeric types above become typed arrays, where
+// encoding/json produces a base64 string and an Array of Numbers; and maps,
+// slices and pointers that contain themselves become cyclic objects and
+// arrays, where encoding/json fails.
+func Marshal(ctx *Context, val interface{}) (*Value, error) {
+	if ctx == nil {
+		return nil, errors.New("v8go: Context is required")
+	}
+	e := tapeEncoderPool.Get().(*tapeEncoder)
+	defer func() {
+		e.reset()
+		tapeEncoderPool.Put(e)
+	}()
+	if err := e.encode(val, 0); err != nil {
+		return nil, err
+	}
+
+	rtn := C.NewValueFromTape(ctx.ptr, (*C.uint8_t)(unsafe.Pointer(&e.buf[0])), C.int(len(e.buf)))
+	return valueResult(ctx, rtn)
+}
+
+// Export converts the value into its Go equivalent in a single call into V8,
+// without going through JSON. The result mirrors what json.Unmarshal produces
+// for an interface{}:
+//
+//	undefined, null -> nil
+//	Boolean -> bool
+//	Number -> float64
+//	String -> string
+//	BigInt -> *big.Int
+//	Array -> []interface{}
+//	ArrayBuffer, DataView, Uint8Array, Uint8ClampedArray -> []byte
+//	other typed arrays -> slices of the matching element type, such as
+//	Float64Array -> []float64 and BigInt64Array -> []int64
+//	Object -> map[string]interface{} of its own enumerable string keys
+//
+// Functions and symbols export as nil. An object or array that contains
+// itself becomes a map or slice that contains itself; other values that are
+// referenced more than once are copied for every reference.
+func (v *Value) Export() (interface{}, error) {
+	rtn := C.ValueToTape(v.ptr)
+	if rtn.data == nil {
+		return nil, newJSError(rtn.error)
+	}
+	defer C.free(unsafe.Pointer(rtn.data))
+
+	d := tapeDecoder{data: unsafe.Slice((*byte)(unsafe.Pointer(rtn.data)), int(rtn.length))}
+	return d.decode(0)
+}
@@ -0,0 +1,471 @@
+// Copyright 2023 the v8go contributors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+package v8go_test
+
+import (
+	"encoding/json"
+	"fmt"
+	"math/big"
+	"reflect"
+	"strings"
+	"testing"
+
+	v8 "github.com/ionos-cloud/v8go"
+)
+
+type marshalAddress struct {
+	Street string `json:"street"`
+	City   string `json:"city"`
+}
+
+type marshalPerson struct {
+	marshalAddress
+	Name    string            `json:"name"`
+	Age     int               `json:"age"`
+	Email   string            `json:"email,omitempty"`
+	Tags    []string          `json:"tags"`
+	Meta    map[string]string `json:"meta"`
+	Secret  string            `json:"-"`
+	Balance float64
+}
+
+type marshalNode struct {
+	Name string       `json:"name"`
+	Next *marshalNode `json:"next"`
+}
+
+func TestMarshal(t *testing.T) {
+	t.Parallel()
+
+	ctx := v8.NewContext()
+	defer ctx.Isolate().Dispose()
+	defer ctx.Close()
+
+	if _, err := v8.Marshal(nil, 1); err == nil {
+		t.Error("expected error with <nil> Context")
+	}
+
+	fn, _ := ctx.RunScript("(function() { return 42 })", "fn.js")
+
+	tests := [...]struct {
+		name   string
+		val    interface{}
+		expect string
+	}{
+		{"nil", nil, "null"},
+		{"bool", true, "true"},
+		{"int", 42, "42"},
+		{"int64", int64(1) << 40, "1099511627776"},
+		{"uint8", uint8(7), "7"},
+		{"float", 1.5, "1.5"},
+		{"string", "foo\x00bar", `"foo\u0000bar"`},
+		{"slice", []interface{}{1, "a", false, nil}, `[1,"a",false,null]`},
+		{"typed slice", []int{1, 2, 3}, "[1,2,3]"},
+		{"array", [2]string{"a", "b"}, `["a","b"]`},
+		{"nil slice", []int(nil), "null"},
+		{"map", map[string]interface{}{"a": 1}, `{"a":1}`},
+		{"int keys", map[int]bool{1: true}, `{"1":true}`},
+		{"struct", marshalPerson{
+			marshalAddress: marshalAddress{"Main St", "Springfield"},
+			Name:           "Homer",
+			Age:            39,
+			Tags:           []string{"dad"},
+			Secret:         "donut",
+			Balance:        -1.25,
+		}, `{"street":"Main St","city":"Springfield","name":"Homer","age":39,"tags":["dad"],"meta":null,"Balance":-1.25}`},
+		{"pointer", &marshalAddress{"a", "b"}, `{"street":"a","city":"b"}`},
+		{"value", map[string]interface{}{"fn": fn}, "42"},
+	}
+
+	for _, tt := range tests {
+		tt := tt
+		t.Run(tt.name, func(t *testing.T) {
+			val, err := v8.Marshal(ctx, tt.val)
+			fatalIf(t, err)
+			if tt.name == "value" {
+				obj, _ := val.AsObject()
+				rtn, err := obj.MethodCall("fn")
+				fatalIf(t, err)
+				val = rtn
+			}
+			got, err := v8.JSONStringify(ctx, val)
+			fatalIf(t, err)
+			if got != tt.expect {
+				t.Errorf("expected %s, got %s", tt.expect, got)
+			}
+		})
+	}
+
+	big, err := v8.Marshal(ctx, new(big.Int).Lsh(big.NewInt(-1), 100))
+	fatalIf(t, err)
+	if !big.IsBigInt() || big.String() != "-1267650600228229401496703205376" {
+		t.Errorf("unexpected bigint value: %s", big)
+	}
+
+	if _, err := v8.Marshal(ctx, map[string]interface{}{"ch": make(chan int)}); err == nil {
+		t.Error("expected error for unsupported type")
+	}
+	if _, err := v8.Marshal(ctx, map[bool]int{true: 1}); err == nil {
+		t.Error("expected error for unsupported map key type")
+	}
+}
+
+func TestMarshalTypedAndCyclic(t *testing.T) {
+	t.Parallel()
+
+	ctx := v8.NewContext()
+	defer ctx.Isolate().Dispose()
+	defer ctx.Close()
+
+	cyclicMap := map[string]interface{}{"a": 1}
+	cyclicMap["self"] = cyclicMap
+	cyclicSlice := []interface{}{1, nil}
+	cyclicSlice[1] = cyclicSlice
+	node := &marshalNode{Name: "a", Next: &marshalNode{Name: "b"}}
+	node.Next.Next = node
+
+	tests := [...]struct {
+		name   string
+		val    interface{}
+		source string
+	}{
+		{"bytes", []byte{1, 2, 255}, "v instanceof Uint8Array && v.join() === '1,2,255'"},
+		{"empty bytes", []byte{}, "v instanceof Uint8Array && v.length === 0"},
+		{"float64s", []float64{1.5, -2}, "v instanceof Float64Array && v.join() === '1.5,-2'"},
+		{"int16s", []int16{-1, 300}, "v instanceof Int16Array && v.join() === '-1,300'"},
+		{"int64s", []int64{1, 2}, "Array.isArray(v) && v.join() === '1,2'"},
+		{"cyclic map", cyclicMap, "v.self === v && v.a === 1"},
+		{"cyclic slice", cyclicSlice, "v[1] === v && v[0] === 1"},
+		{"cyclic pointer", node, "v.next.next === v && v.next.name === 'b'"},
+		{"shared", []interface{}{node.Next, node.Next}, "v[0] !== v[1] && v[0].next.next === v[0]"},
+	}
+
+	for _, tt := range tests {
+		tt := tt
+		t.Run(tt.name, func(t *testing.T) {
+			val, err := v8.Marshal(ctx, tt.val)
+			fatalIf(t, err)
+			fn, _ := ctx.RunScript("(v) => "+tt.source, "check.js")
+			f, _ := fn.AsFunction()
+			rtn, err := f.Call(v8.Undefined(ctx.Isolate()), val)
+			fatalIf(t, err)
+			if !rtn.Boolean() {
+				t.Errorf("expected %s", tt.source)
+			}
+		})
+	}
+}
+
+func TestMarshalKeyOrder(t *testing.T) {
+	t.Parallel()
+
+	ctx := v8.NewContext()
+	defer ctx.Isolate().Dispose()
+	defer ctx.Close()
+
+	keys, _ := ctx.RunScript("(v) => Object.keys(v).join()", "keys.js")
+	fn, _ := keys.AsFunction()
+	generic := make(map[string]interface{})
+	typed := make(map[int]bool)
+	for i := 0; i < 20; i++ {
+		generic[fmt.Sprintf("k%d", i)] = i
+		typed[i*7] = true
+	}
+
+	for _, m := range []interface{}{generic, typed} {
+		b, err := json.Marshal(m)
+		fatalIf(t, err)
+		parsed, err := v8.JSONParse(ctx, string(b))
+		fatalIf(t, err)
+		want, err := fn.Call(v8.Undefined(ctx.Isolate()), parsed)
+		fatalIf(t, err)
+		// the iteration order of Go maps changes from one range to the next
+		for i := 0; i < 5; i++ {
+			val, err := v8.Marshal(ctx, m)
+			fatalIf(t, err)
+			got, err := fn.Call(v8.Undefined(ctx.Isolate()), val)
+			fatalIf(t, err)
+			if got.String() != want.String() {
+				t.Fatalf("expected the keys of JSONParse %s, got %s", want, got)
+			}
+		}
+	}
+}
+
+func TestMarshalOmitEmpty(t *testing.T) {
+	t.Parallel()
+
+	ctx := v8.NewContext()
+	defer ctx.Isolate().Dispose()
+	defer ctx.Close()
+
+	type fields struct {
+		Slice  []int          `json:"slice,omitempty"`
+		Map    map[string]int `json:"map,omitempty"`
+		Array  [0]int         `json:"array,omitempty"`
+		Ptr    *int           `json:"ptr,omitempty"`
+		Struct struct{}       `json:"struct,omitempty"`
+		Zero   float64        `json:"zero,omitempty"`
+	}
+	for _, v := range []fields{{}, {Slice: []int{}, Map: map[string]int{}}} {
+		b, err := json.Marshal(v)
+		fatalIf(t, err)
+		val, err := v8.Marshal(ctx, v)
+		fatalIf(t, err)
+		got, err := v8.JSONStringify(ctx, val)
+		fatalIf(t, err)
+		if got != string(b) {
+			t.Errorf("expected %s like encoding/json, got %s", b, got)
+		}
+	}
+}
+
+func TestMarshalTypedArraysUnlikeJSON(t *testing.T) {
+	t.Parallel()
+
+	ctx := v8.NewContext()
+	defer ctx.Isolate().Dispose()
+	defer ctx.Close()
+
+	// where encoding/json produces a base64 string and an Array, Marshal
+	// produces typed arrays
+	check, _ := ctx.RunScript(`(v) => v.bytes instanceof Uint8Array &&
+		v.floats instanceof Float64Array && v.ints instanceof Int32Array`, "check.js")
+	fn, _ := check.AsFunction()
+	in := map[string]interface{}{
+		"bytes":  []byte("hi"),
+		"floats": []float64{1.5},
+		"ints":   []int32{1},
+	}
+	b, err := json.Marshal(in)
+	fatalIf(t, err)
+	if string(b) != `{"bytes":"aGk=","floats":[1.5],"ints":[1]}` {
+		t.Fatalf("unexpected encoding/json output %s", b)
+	}
+	val, err := v8.Marshal(ctx, in)
+	fatalIf(t, err)
+	typed, err := fn.Call(v8.Undefined(ctx.Isolate()), val)
+	fatalIf(t, err)
+	if !typed.Boolean() {
+		t.Error("expected the slices to become typed arrays")
+	}
+}
+
+func TestMarshalArrayBufferLimit(t *testing.T) {
+	t.Parallel()
+
+	iso := v8.NewIsolate(v8.ArrayBufferAllocator{MaxBytes: 1 << 10})
+	defer iso.Dispose()
+	ctx := v8.NewContext(iso)
+	defer ctx.Close()
+
+	if _, err := v8.Marshal(ctx, make([]byte, 4<<10)); err == nil || !strings.Contains(err.Error(), "RangeError") {
+		t.Errorf("expected a RangeError beyond the allocator limit, got %v", err)
+	}
+	val, err := v8.Marshal(ctx, []interface{}{make([]byte, 512)})
+	fatalIf(t, err)
+	if !val.IsArray() {
+		t.Errorf("expected buffers under the limit to be allocated, got %v", val)
+	}
+}
+
+func TestValueExport(t *testing.T) {
+	t.Parallel()
+
+	ctx := v8.NewContext()
+	defer ctx.Isolate().Dispose()
+	defer ctx.Close()
+
+	tests := [...]struct {
+		source string
+		expect interface{}
+	}{
+		{"undefined", nil},
+		{"null", nil},
+		{"true", true},
+		{"-7", float64(-7)},
+		{"0.5", 0.5},
+		{"'héllo \\ud800'", "héllo �"},
+		{"[1, 'a', [null]]", []interface{}{float64(1), "a", []interface{}{nil}}},
+		{"({a: {b: 1}, [Symbol()]: 2, 0: 'x'})", map[string]interface{}{"0": "x", "a": map[string]interface{}{"b": float64(1)}}},
+		{"(() => {})", nil},
+		{"2n ** 70n", new(big.Int).Lsh(big.NewInt(1), 70)},
+		{"[{a: 1, é: 'ÿ'}, {a: 2, é: 'ĳ'}]", []interface{}{
+			map[string]interface{}{"a": float64(1), "é": "ÿ"},
+			map[string]interface{}{"a": float64(2), "é": "ĳ"},
+		}},
+		{"new Uint8Array([1, 2, 255])", []byte{1, 2, 255}},
+		{"new Uint8Array(0)", []byte{}},
+		{"new Float64Array([1, 2.5, 3]).subarray(1)", []float64{2.5, 3}},
+		{"new Int32Array([-1, 7])", []int32{-1, 7}},
+		{"new BigInt64Array([-1n])", []int64{-1}},
+		{"new Uint8Array([1, 2, 3]).buffer", []byte{1, 2, 3}},
+		{"new DataView(new Uint8Array([4, 5]).buffer, 1)", []byte{5}},
+	}
+
+	for _, tt := range tests {
+		val, err := ctx.RunScript(tt.source, "export.js")
+		fatalIf(t, err)
+		got, err := val.Export()
+		fatalIf(t, err)
+		if !reflect.DeepEqual(got, tt.expect) {
+			t.Errorf("%s: expected %#v, got %#v", tt.source, tt.expect, got)
+		}
+	}
+
+	cyclic, _ := ctx.RunScript("const o = {a: [1]}; o.self = o; o.a.push(o.a); o", "cyclic.js")
+	got, err := cyclic.Export()
+	fatalIf(t, err)
+	obj := got.(map[string]interface{})
+	if self, ok := obj["self"].(map[string]interface{}); !ok || reflect.ValueOf(self).Pointer() != reflect.ValueOf(obj).Pointer() {
+		t.Errorf("expected self reference, got %#v", obj["self"])
+	}
+	arr := obj["a"].([]interface{})
+	if inner, ok := arr[1].([]interface{}); !ok || &inner[0] != &arr[0] {
+		t.Errorf("expected array self reference, got %#v", arr[1])
+	}
+
+	shared, _ := ctx.RunScript("const s = {}; [s, s]", "shared.js")
+	if _, err := shared.Export(); err != nil {
+		t.Errorf("unexpected error exporting shared non-cyclic value: %v", err)
+	}
+
+	throwing, _ := ctx.RunScript("({get x() { throw new Error('boom') }})", "getter.js")
+	if _, err := throwing.Export(); err == nil || err.Error() != "Error: boom" {
+		t.Errorf("expected getter error, got %v", err)
+	}
+}
+
+func TestMarshalRoundTrip(t *testing.T) {
+	t.Parallel()
+
+	ctx := v8.NewContext()
+	defer ctx.Isolate().Dispose()
+	defer ctx.Close()
+
+	var expect interface{}
+	b, _ := json.Marshal(makePayload(20))
+	json.Unmarshal(b, &expect)
+
+	val, err := v8.Marshal(ctx, makePayload(20))
+	fatalIf(t, err)
+	got, err := val.Export()
+	fatalIf(t, err)
+	if !reflect.DeepEqual(got, expect) {
+		t.Errorf("round trip mismatch:\nexpected %v\ngot      %v", expect, got)
+	}
+
+	for _, typed := range []interface{}{[]byte{1, 2}, []int8{-1}, []uint16{1}, []int16{-1}, []uint32{1}, []int32{-1}, []float32{0.5}, []float64{0.25}} {
+		val, err := v8.Marshal(ctx, typed)
+		fatalIf(t, err)
+		got, err := val.Export()
+		fatalIf(t, err)
+		if !reflect.DeepEqual(got, typed) {
+			t.Errorf("round trip mismatch: expected %#v, got %#v", typed, got)
+		}
+	}
+}
+
+type payloadItem struct {
+	ID       int               `json:"id"`
+	Name     string            `json:"name"`
+	Price    float64           `json:"price"`
+	InStock  bool              `json:"inStock"`
+	Tags     []string          `json:"tags"`
+	Attrs    map[string]string `json:"attrs"`
+	Variants []payloadVariant  `json:"variants"`
+}
+
+type payloadVariant struct {
+	SKU   string `json:"sku"`
+	Stock int    `json:"stock"`
+}
+
+func makePayload(n int) map[string]interface{} {
+	items := make([]payloadItem, n)
+	for i := range items {
+		items[i] = payloadItem{
+			ID:      i,
+			Name:    fmt.Sprintf("Product %d", i),
+			Price:   float64(i) * 1.25,
+			InStock: i%2 == 0,
+			Tags:    []string{"new", "sale", "featured"},
+			Attrs:   map[string]string{"color": "red", "size": "M"},
+			Variants: []payloadVariant{
+				{SKU: fmt.Sprintf("SKU-%d-A", i), Stock: i},
+				{SKU: fmt.Sprintf("SKU-%d-B", i), Stock: i * 2},
+			},
+		}
+	}
+	return map[string]interface{}{
+		"page":  1,
+		"total": n,
+		"items": items,
+	}
+}
+
+func BenchmarkMarshal(b *testing.B) {
+	ctx := v8.NewContext()
+	defer ctx.Isolate().Dispose()
+	defer ctx.Close()
+	payload := makePayload(100)
+
+	b.Run("Tape", func(b *testing.B) {
+		b.ReportAllocs()
+		for n := 0; n < b.N; n++ {
+			val, err := v8.Marshal(ctx, payload)
+			if err != nil {
+				b.Fatal(err)
+			}
+			val.Release()
+		}
+	})
+	b.Run("JSON", func(b *testing.B) {
+		b.ReportAllocs()
+		for n := 0; n < b.N; n++ {
+			str, err := json.Marshal(payload)
+			if err != nil {
+				b.Fatal(err)
+			}
+			val, err := v8.JSONParse(ctx, string(str))
+			if err != nil {
+				b.Fatal(err)
+			}
+			val.Release()
+		}
+	})
+}
+
+func BenchmarkValueExport(b *testing.B) {
+	ctx := v8.NewContext()
+	defer ctx.Isolate().Dispose()
+	defer ctx.Close()
+	val, err := v8.Marshal(ctx, makePayload(100))
+	if err != nil {
+		b.Fatal(err)
+	}
+
+	b.Run("Tape", func(b *testing.B) {
+		b.ReportAllocs()
+		for n := 0; n < b.N; n++ {
+			if _, err := val.Export(); err != nil {
+				b.Fatal(err)
+			}
+		}
+	})
+	b.Run("JSON", func(b *testing.B) {
+		b.ReportAllocs()
+		for n := 0; n < b.N; n++ {
+			str, err := v8.JSONStringify(ctx, val)
+			if err != nil {
+				b.Fatal(err)
+			}
+			var out interface{}
+			if err := json.Unmarshal([]byte(str), &out); err != nil {
+				b.Fatal(err)
+			}
+		}
+	})
+}
@@ -0,0 +1,266 @@
+// Copyright 2023 the v8go contributors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+package v8go
+
+// #include "v8go.h"
+import "C"
+
+import (
+	"time"
+)
+
+// HeapSpaceStatistics represents the statistics of one of the spaces the V8
+// heap is divided in, such as "new_space", where the young generation is
+// allocated and collected by scavenges, or "old_space".
+type HeapSpaceStatistics struct {
+	SpaceName          string
+	SpaceSize          uint64
+	SpaceUsedSize      uint64
+	SpaceAvailableSize uint64
+	PhysicalSpaceSize  uint64
+}
+
+// HeapCodeStatistics represents the memory used by the code of an isolate.
+type HeapCodeStatistics struct {
+	CodeAndMetadataSize      uint64
+	BytecodeAndMetadataSize  uint64
+	ExternalScriptSourceSize uint64
+	CPUProfilerMetadataSize  uint64
+}
+
+// HeapObjectStatistics represents the objects of one type that were alive at
+// the last garbage collection.
+type HeapObjectStatistics struct {
+	ObjectType    string
+	ObjectSubType string
+	ObjectCount   uint64
+	ObjectSize    uint64
+}
+
+// GCType is a type of garbage collection.
+type GCType int
+
+const (
+	GCScavenge             GCType = 1 << 0
+	GCMinorMarkCompact     GCType = 1 << 1
+	GCMarkSweepCompact     GCType = 1 << 2
+	GCIncrementalMarking   GCType = 1 << 3
+	GCProcessWeakCallbacks GCType = 1 << 4
+)
+
+var gcTypes = []GCType{
+	GCScavenge,
+	GCMinorMarkCompact,
+	GCMarkSweepCompact,
+	GCIncrementalMarking,
+	GCProcessWeakCallbacks,
+}
+
+func (t GCType) String() string {
+	switch t {
+	case GCScavenge:
+		return "scavenge"
+	case GCMinorMarkCompact:
+		return "minor-mark-compact"
+	case GCMarkSweepCompact:
+		return "mark-sweep-compact"
+	case GCIncrementalMarking:
+		return "incremental-marking"
+	case GCProcessWeakCallbacks:
+		return "process-weak-callbacks"
+	}
+	return "unknown"
+}
+
+// GCEvent is a garbage collection, from its prologue to its epilogue.
+type GCEvent struct {
+	Type GCType
+	// Forced is set for the collections requested by the embedder rather
+	// than triggered by allocations, such as a low memory notification.
+	Forced   bool
+	Start    time.Time
+	Duration time.Duration
+	// UsedHeapBefore and UsedHeapAfter are the used heap size at the start
+	// and at the end of the collection.
+	UsedHeapBefore uint64
+	UsedHeapAfter  uint64
+}
+
+// GCStatistics totals the garbage collections of a type since GC tracking
+// started, including those whose events were dropped.
+type GCStatistics struct {
+	Type  GCType
+	Count uint64
+	Total time.Duration
+	Max   time.Duration
+}
+
+// Metrics gathers the statistics of an isolate, as collected by
+// Isolate.CollectMetrics.
+type Metrics struct {
+	Heap       HeapStatistics
+	HeapSpaces []HeapSpaceStatistics
+	HeapCode   HeapCodeStatistics
+	// HeapObjects is empty unless V8 runs with --track-gc-object-stats.
+	HeapObjects []HeapObjectStatistics
+	Execution   ExecutionStatistics
+	// GC and GCEvents are empty unless GC tracking was started.
+	GC       []GCStatistics
+	GCEvents []GCEvent
+}
+
+// MetricsExporter exports the metrics of isolates to a monitoring system.
+// Calling Isolate.ExportMetrics periodically, for example from a
+// time.Ticker, feeds it the statistics of the isolate and the garbage
+// collections since the previous call, to correlate latency spikes with
+// scavenges and mark-compacts.
+type MetricsExporter interface {
+	ExportMetrics(iso *Isolate, m *Metrics) error
+}
+
+// GetHeapSpaceStatistics returns the statistics of each space of the heap.
+func (i *Isolate) GetHeapSpaceStatistics() []HeapSpaceStatistics {
+	n := int(C.IsolateNumberOfHeapSpaces(i.ptr))
+	spaces := make([]HeapSpaceStatistics, 0, n)
+	for index := 0; index < n; index++ {
+		hs := C.IsolateGetHeapSpaceStatistics(i.ptr, C.int(index))
+		if hs.space_name == nil {
+			continue
+		}
+		spaces = append(spaces, HeapSpaceStatistics{
+			SpaceName:          C.GoString(hs.space_name),
+			SpaceSize:          uint64(hs.space_size),
+			SpaceUsedSize:      uint64(hs.space_used_size),
+			SpaceAvailableSize: uint64(hs.space_available_size),
+			PhysicalSpaceSize:  uint64(hs.physical_space_size),
+		})
+	}
+	return spaces
+}
+
+// GetHeapCodeStatistics returns the memory used by code, bytecode and script
+// sources. It walks the heap, so it waits for the isolate to be free.
+func (i *Isolate) GetHeapCodeStatistics() HeapCodeStatistics {
+	hs := C.IsolateGetHeapCodeStatistics(i.ptr)
+	return HeapCodeStatistics{
+		CodeAndMetadataSize:      uint64(hs.code_and_metadata_size),
+		BytecodeAndMetadataSize:  uint64(hs.bytecode_and_metadata_size),
+		ExternalScriptSourceSize: uint64(hs.external_script_source_size),
+		CPUProfilerMetadataSize:  uint64(hs.cpu_profiler_metadata_size),
+	}
+}
+
+// GetHeapObjectStatistics returns the statistics of the object types that
+// were alive at the last garbage collection. They are only gathered when V8
+// runs with the --track-gc-object-stats flag, see SetFlags; otherwise it
+// returns nil.
+func (i *Isolate) GetHeapObjectStatistics() []HeapObjectStatistics {
+	n := int(C.IsolateNumberOfTrackedHeapObjectTypes(i.ptr))
+	var objects []HeapObjectStatistics
+	for index := 0; index < n; index++ {
+		var hs C.HeapObjectStats
+		if C.IsolateGetHeapObjectStatistics(i.ptr, C.int(index), &hs) == 0 {
+			return nil
+		}
+		if hs.object_count == 0 {
+			continue
+		}
+		objects = append(objects, HeapObjectStatistics{
+			ObjectType:    C.GoString(hs.object_type),
+			ObjectSubType: C.GoString(hs.object_sub_type),
+			ObjectCount:   uint64(hs.object_count),
+			ObjectSize:    uint64(hs.object_size),
+		})
+	}
+	return objects
+}
+
+// StartGCTracking starts recording the garbage collections of the isolate,
+// with prologue and epilogue callbacks that time each collection. The latest
+// 1024 events are kept until TakeGCEvents returns them.
+func (i *Isolate) StartGCTracking() {
+	i.gcMutex.Lock()
+	defer i.gcMutex.Unlock()
+	C.IsolateStartGCTracking(i.ptr)
+}
+
+// StopGCTracking stops recording garbage collections, discarding the events
+// and statistics recorded so far.
+func (i *Isolate) StopGCTracking() {
+	i.gcMutex.Lock()
+	defer i.gcMutex.Unlock()
+	C.IsolateStopGCTracking(i.ptr)
+}
+
+// TakeGCEvents returns the garbage collections recorded since the previous
+// call, oldest first. It does not wait for the isolate to be free.
+func (i *Isolate) TakeGCEvents() []GCEvent {
+	i.gcMutex.Lock()
+	defer i.gcMutex.Unlock()
+	if i.ptr == nil {
+		return nil
+	}
+	var buf [1024]C.GCEvent
+	n := int(C.IsolateTakeGCEvents(i.ptr, &buf[0], C.int(len(buf))))
+	if n == 0 {
+		return nil
+	}
+	events := make([]GCEvent, n)
+	for j, e := range buf[:n] {
+		events[j] = GCEvent{
+			Type:           GCType(e.gc_type),
+			Forced:         e.flags&C.GCCallbackFlagForced != 0,
+			Start:          time.Unix(0, int64(e.start)),
+			Duration:       time.Duration(e.duration),
+			UsedHeapBefore: uint64(e.used_before),
+			UsedHeapAfter:  uint64(e.used_after),
+		}
+	}
+	return events
+}
+
+// GetGCStatistics returns the totals of each type of garbage collection since
+// GC tracking started, or nil if it is not on.
+func (i *Isolate) GetGCStatistics() []GCStatistics {
+	i.gcMutex.Lock()
+	defer i.gcMutex.Unlock()
+	if i.ptr == nil {
+		return nil
+	}
+	var stats []GCStatistics
+	for _, t := range gcTypes {
+		gs := C.IsolateGetGCStatistics(i.ptr, C.int(t))
+		if gs.count == 0 {
+			continue
+		}
+		stats = append(stats, GCStatistics{
+			Type:  t,
+			Count: uint64(gs.count),
+			Total: time.Duration(gs.total),
+			Max:   time.Duration(gs.max),
+		})
+	}
+	return stats
+}
+
+// CollectMetrics collects the statistics of the isolate, taking its pending
+// GC events.
+func (i *Isolate) CollectMetrics() *Metrics {
+	return &Metrics{
+		Heap:        i.GetHeapStatistics(),
+		HeapSpaces:  i.GetHeapSpaceStatistics(),
+		HeapCode:    i.GetHeapCodeStatistics(),
+		HeapObjects: i.GetHeapObjectStatistics(),
+		Execution:   i.GetExecutionStatistics(),
+		GC:          i.GetGCStatistics(),
+		GCEvents:    i.TakeGCEvents(),
+	}
+}
+
+// ExportMetrics collects the metrics of the isolate and passes them to e,
+// returning its error.
+func (i *Isolate) ExportMetrics(e MetricsExporter) error {
+	return e.ExportMetrics(i, i.CollectMetrics())
+}
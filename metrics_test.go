@@ -0,0 +1,123 @@
+// Copyright 2023 the v8go contributors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+package v8go_test
+
+import (
+	"testing"
+	"time"
+
+	v8 "github.com/ionos-cloud/v8go"
+)
+
+func TestIsolateHeapSpaceAndCodeStatistics(t *testing.T) {
+	t.Parallel()
+
+	ctx := v8.NewContext()
+	iso := ctx.Isolate()
+	defer iso.Dispose()
+	defer ctx.Close()
+	_, err := ctx.RunScript("function f() { return 1 }; f()", "f.js")
+	fatalIf(t, err)
+
+	spaces := make(map[string]v8.HeapSpaceStatistics)
+	for _, s := range iso.GetHeapSpaceStatistics() {
+		spaces[s.SpaceName] = s
+		if s.SpaceUsedSize > s.SpaceSize {
+			t.Errorf("expected %s to use at most its size, got %+v", s.SpaceName, s)
+		}
+	}
+	for _, name := range []string{"new_space", "old_space", "code_space"} {
+		if _, ok := spaces[name]; !ok {
+			t.Errorf("expected the statistics of %s, got %v", name, spaces)
+		}
+	}
+
+	if cs := iso.GetHeapCodeStatistics(); cs.BytecodeAndMetadataSize == 0 {
+		t.Errorf("expected the bytecode of the script to be counted, got %+v", cs)
+	}
+	// only gathered with --track-gc-object-stats
+	if objects := iso.GetHeapObjectStatistics(); objects != nil {
+		t.Errorf("expected no object statistics, got %d", len(objects))
+	}
+}
+
+type testExporter struct {
+	metrics []*v8.Metrics
+}
+
+func (e *testExporter) ExportMetrics(iso *v8.Isolate, m *v8.Metrics) error {
+	e.metrics = append(e.metrics, m)
+	return nil
+}
+
+func TestIsolateGCTracking(t *testing.T) {
+	t.Parallel()
+
+	ctx := v8.NewContext()
+	iso := ctx.Isolate()
+	defer iso.Dispose()
+	defer ctx.Close()
+
+	if stats := iso.GetGCStatistics(); stats != nil {
+		t.Errorf("expected no statistics before tracking, got %v", stats)
+	}
+	start := time.Now()
+	iso.StartGCTracking()
+	_, err := ctx.RunScript(`
+		for (let i = 0; i < 100000; i++) new Array(100).fill(i);`, "garbage.js")
+	fatalIf(t, err)
+
+	exporter := &testExporter{}
+	fatalIf(t, iso.ExportMetrics(exporter))
+	m := exporter.metrics[0]
+	var scavenges uint64
+	for _, e := range m.GCEvents {
+		if e.Type != v8.GCScavenge {
+			continue
+		}
+		scavenges++
+		if e.Start.Before(start.Add(-time.Second)) || e.Duration <= 0 {
+			t.Errorf("expected the scavenge to be timed, got %+v", e)
+		}
+		if e.UsedHeapAfter >= e.UsedHeapBefore {
+			t.Errorf("expected the scavenge to free garbage, got %+v", e)
+		}
+	}
+	if scavenges == 0 {
+		t.Fatalf("expected scavenges, got %v", m.GCEvents)
+	}
+	if len(m.GC) == 0 || m.GC[0].Type != v8.GCScavenge || m.GC[0].Count != scavenges {
+		t.Errorf("expected the statistics to count %d scavenges, got %+v", scavenges, m.GC)
+	}
+	if m.Heap.UsedHeapSize == 0 || len(m.HeapSpaces) == 0 || m.Execution.Entries == 0 {
+		t.Errorf("expected the metrics of the isolate, got %+v", m)
+	}
+	if events := iso.TakeGCEvents(); events != nil {
+		t.Errorf("expected the events to be taken once, got %d", len(events))
+	}
+
+	iso.StopGCTracking()
+	if stats := iso.GetGCStatistics(); stats != nil {
+		t.Errorf("expected no statistics after tracking, got %v", stats)
+	}
+}
+
+func TestIsolateMetricsAfterDispose(t *testing.T) {
+	t.Parallel()
+
+	iso := v8.NewIsolate()
+	iso.StartGCTracking()
+	iso.Dispose()
+
+	// like GetHeapStatistics, the metrics of a disposed isolate are empty
+	iso.StartGCTracking()
+	m := iso.CollectMetrics()
+	if m.Heap != (v8.HeapStatistics{}) || len(m.HeapSpaces) != 0 ||
+		m.HeapCode != (v8.HeapCodeStatistics{}) || m.HeapObjects != nil ||
+		m.Execution != (v8.ExecutionStatistics{}) || m.GC != nil || m.GCEvents != nil {
+		t.Errorf("expected no metrics after Dispose, got %+v", m)
+	}
+	iso.StopGCTracking()
+}
@@ -0,0 +1,350 @@
+// Copyright 2023 the v8go contributors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+package v8go
+
+// #include <stdlib.h>
+// #include "v8go.h"
+import "C"
+
+import (
+	"errors"
+	"fmt"
+	"unsafe"
+)
+
+// Module is an ECMAScript module compiled in a Context. A module goes through
+// three steps: it is compiled, instantiated, which links its imports to other
+// modules, and evaluated.
+type Module struct {
+	ptr  C.ModulePtr
+	ctx  *Context
+	name string
+}
+
+// ModuleStatus is the status of a Module.
+type ModuleStatus int
+
+const (
+	ModuleUninstantiated ModuleStatus = iota
+	ModuleInstantiating
+	ModuleInstantiated
+	ModuleEvaluating
+	ModuleEvaluated
+	ModuleErrored
+)
+
+// ModuleResolver returns the module that referrer imports as specifier. It is
+// typically implemented by normalizing the specifier relative to the name of
+// the referrer, then returning Context.Module for that name or compiling the
+// module's source with Context.CompileModule under that name.
+type ModuleResolver func(ctx *Context, specifier string, referrer *Module) (*Module, error)
+
+// DynamicImportHandler is called for each import() evaluated in a context.
+// It loads the requested module, asynchronously if it needs to, and then
+// completes the import with DynamicImport.Resolve or DynamicImport.Reject.
+type DynamicImportHandler func(ctx *Context, imp *DynamicImport)
+
+// ImportMetaHandler adds host-defined properties to the import.meta object of
+// a module, the first time the module accesses it.
+type ImportMetaHandler func(m *Module, meta *Object)
+
+// DynamicImport is an import() waiting for its module.
+type DynamicImport struct {
+	ctx       *Context
+	specifier string
+	referrer  string
+	resolver  C.ValuePtr
+	done      bool
+}
+
+// CompileModule compiles the source as a module named name, typically its URL
+// or path, which is also used as its origin in errors and stack traces.
+//
+// Like the module map of a browser, the context keeps the modules compiled in
+// it by name: compiling a name again returns the module compiled before
+// without compiling the source. Use Module to look one up without the source.
+//
+// As with CompileUnboundScript, opts may contain CachedData created by
+// Module.CreateCodeCache to skip compiling the source.
+// error will be of type `JSError` if not nil.
+func (c *Context) CompileModule(source, name string, opts CompileOptions) (*Module, error) {
+	if m := c.Module(name); m != nil {
+		return m, nil
+	}
+
+	cSource := C.CString(source)
+	cName := C.CString(name)
+	defer C.free(unsafe.Pointer(cSource))
+	defer C.free(unsafe.Pointer(cName))
+
+	var cOptions C.CompileOptions
+	if opts.CachedData != nil {
+		if opts.Mode != 0 {
+			panic("On CompileOptions, Mode and CachedData can't both be set")
+		}
+		cOptions.compileOption = C.ScriptCompilerConsumeCodeCache
+		cOptions.cachedData = C.ScriptCompilerCachedData{
+			data:   (*C.uchar)(unsafe.Pointer(&opts.CachedData.Bytes[0])),
+			length: C.int(len(opts.CachedData.Bytes)),
+		}
+	} else {
+		cOptions.compileOption = C.int(opts.Mode)
+	}
+
+	rtn := C.CompileModule(c.ptr, cSource, cName, cOptions)
+	if rtn.ptr == nil {
+		return nil, newJSError(rtn.error)
+	}
+	if opts.CachedData != nil {
+		opts.CachedData.Rejected = int(rtn.cachedDataRejected) == 1
+	}
+
+	m := &Module{ptr: rtn.ptr, ctx: c, name: name}
+	c.modMutex.Lock()
+	defer c.modMutex.Unlock()
+	if c.modules == nil {
+		c.modules = make(map[string]*Module)
+		c.modulePtrs = make(map[C.ModulePtr]*Module)
+	}
+	c.modules[name] = m
+	c.modulePtrs[m.ptr] = m
+	return m, nil
+}
+
+// Module returns the module compiled in the context under name, or nil.
+func (c *Context) Module(name string) *Module {
+	c.modMutex.Lock()
+	defer c.modMutex.Unlock()
+	return c.modules[name]
+}
+
+// SetDynamicImportHandler sets the handler of the import() expressions
+// evaluated in the context, by scripts or modules. The handler is called from
+// the microtask queue of the context rather than from within import(), so a
+// module loaded from a cache can be resolved right away, and one fetched
+// from elsewhere later, at which point its promise settles on the next
+// microtask checkpoint. Without a handler, import() is rejected.
+func (c *Context) SetDynamicImportHandler(handler DynamicImportHandler) {
+	c.modMutex.Lock()
+	defer c.modMutex.Unlock()
+	c.importHandler = handler
+}
+
+// SetImportMetaHandler sets the handler that initializes import.meta for the
+// modules of the context. import.meta.url is always set to the module name.
+func (c *Context) SetImportMetaHandler(handler ImportMetaHandler) {
+	c.modMutex.Lock()
+	defer c.modMutex.Unlock()
+	c.importMetaHandler = handler
+}
+
+// Specifier returns the specifier passed to import().
+func (d *DynamicImport) Specifier() string {
+	return d.specifier
+}
+
+// Referrer returns the name of the script or module that called import().
+func (d *DynamicImport) Referrer() string {
+	return d.referrer
+}
+
+// Resolve completes the import with the module, which is instantiated with
+// resolve, as Module.Instantiate does, and evaluated if it has not been yet.
+// The promise of the import() is fulfilled with the module namespace once the
+// evaluation completes, or rejected with the error it throws. Resolve must be
+// called from the goroutine using the context, and only once per import.
+func (d *DynamicImport) Resolve(m *Module, resolve ModuleResolver) {
+	if m.ctx != d.ctx {
+		d.Reject(fmt.Errorf("Cannot import module '%s' from another context", m.name))
+		return
+	}
+	if d.complete() {
+		return
+	}
+	c := d.ctx
+	c.modMutex.Lock()
+	prev := c.resolver
+	c.resolver = resolve
+	c.modMutex.Unlock()
+
+	C.DynamicImportResolve(c.ptr, d.resolver, m.ptr)
+	c.iso.notifySettled()
+
+	c.modMutex.Lock()
+	c.resolver = prev
+	c.modMutex.Unlock()
+}
+
+// Reject completes the import by rejecting the promise of the import() with
+// an Error whose message is that of err.
+func (d *DynamicImport) Reject(err error) {
+	if d.complete() {
+		return
+	}
+	cMsg := C.CString(err.Error())
+	defer C.free(unsafe.Pointer(cMsg))
+	C.DynamicImportReject(d.ctx.ptr, d.resolver, cMsg)
+	d.ctx.iso.notifySettled()
+}
+
+func (d *DynamicImport) complete() bool {
+	d.ctx.modMutex.Lock()
+	defer d.ctx.modMutex.Unlock()
+	done := d.done
+	d.done = true
+	return done
+}
+
+// Name returns the name the module was compiled under.
+func (m *Module) Name() string {
+	return m.name
+}
+
+// Status returns the status of the module.
+func (m *Module) Status() ModuleStatus {
+	return ModuleStatus(C.ModuleGetStatus(m.ctx.ptr, m.ptr))
+}
+
+// Requests returns the specifiers the module imports, in source order. They
+// can be used to load the modules of a graph ahead of instantiating it.
+func (m *Module) Requests() []string {
+	n := int(C.ModuleGetRequestsLength(m.ctx.ptr, m.ptr))
+	requests := make([]string, n)
+	for i := range requests {
+		cSpecifier := C.ModuleGetRequest(m.ctx.ptr, m.ptr, C.int(i))
+		requests[i] = C.GoString(cSpecifier)
+		C.free(unsafe.Pointer(cSpecifier))
+	}
+	return requests
+}
+
+// Instantiate links the imports of the module and of the modules it imports,
+// recursively, calling resolve for each import. If resolve is nil, imports are
+// resolved by looking up the specifier with Context.Module. Instantiating a
+// module that has already been instantiated does nothing.
+// error will be of type `JSError` if not nil.
+func (m *Module) Instantiate(resolve ModuleResolver) error {
+	c := m.ctx
+	c.modMutex.Lock()
+	prev := c.resolver
+	c.resolver = resolve
+	c.modMutex.Unlock()
+
+	rtn := C.ModuleInstantiate(c.ptr, m.ptr)
+
+	c.modMutex.Lock()
+	c.resolver = prev
+	c.modMutex.Unlock()
+	if rtn.msg != nil {
+		return newJSError(rtn)
+	}
+	return nil
+}
+
+// Evaluate runs the module, after the modules it imports. The result is a
+// Promise, which is only pending if the module graph uses top-level await.
+// An exception thrown during evaluation is returned as the error, which will
+// be of type `JSError`.
+func (m *Module) Evaluate() (*Value, error) {
+	rtn := C.ModuleEvaluate(m.ctx.ptr, m.ptr)
+	return valueResult(m.ctx, rtn)
+}
+
+// Namespace returns the module namespace object, whose properties are the
+// exports of the module. The module must have been instantiated.
+func (m *Module) Namespace() (*Object, error) {
+	if s := m.Status(); s == ModuleUninstantiated || s == ModuleInstantiating {
+		return nil, errors.New("v8go: module has not been instantiated")
+	}
+	return &Object{&Value{C.ModuleGetNamespace(m.ctx.ptr, m.ptr), m.ctx}}, nil
+}
+
+// CreateCodeCache creates a code cache for the module, to be passed as
+// CompileOptions.CachedData to CompileModule in other contexts or isolates.
+// The module must not have been evaluated yet.
+func (m *Module) CreateCodeCache() (*CompilerCachedData, error) {
+	if m.Status() >= ModuleEvaluating {
+		return nil, errors.New("v8go: module has already been evaluated")
+	}
+	rtn := C.ModuleCreateCodeCache(m.ctx.ptr, m.ptr)
+	cachedData := &CompilerCachedData{
+		Bytes:    C.GoBytes(unsafe.Pointer(rtn.data), rtn.length),
+		Rejected: int(rtn.rejected) == 1,
+	}
+	C.ScriptCompilerCachedDataDelete(rtn)
+	return cachedData, nil
+}
+
+//export goResolveModule
+func goResolveModule(ctxref int, specifier *C.char, referrer C.ModulePtr) (C.ModulePtr, *C.char) {
+	ctx := getContext(ctxref)
+	if ctx == nil {
+		return nil, C.CString("Cannot resolve module: the context is closed")
+	}
+	ctx.modMutex.Lock()
+	resolve := ctx.resolver
+	ref := ctx.modulePtrs[referrer]
+	ctx.modMutex.Unlock()
+
+	spec := C.GoString(specifier)
+	var m *Module
+	var err error
+	if resolve != nil {
+		m, err = resolve(ctx, spec, ref)
+	} else if m = ctx.Module(spec); m == nil {
+		err = fmt.Errorf("Cannot find module '%s'", spec)
+	}
+	if err == nil && (m == nil || m.ctx != ctx) {
+		err = fmt.Errorf("Cannot find module '%s' in the context", spec)
+	}
+	if err != nil {
+		return nil, C.CString(err.Error())
+	}
+	return m.ptr, nil
+}
+
+//export goDynamicImport
+func goDynamicImport(ctxref int, specifier, referrer *C.char, resolver C.ValuePtr) {
+	ctx := getContext(ctxref)
+	if ctx == nil {
+		// the context was closed before the import could run
+		return
+	}
+	imp := &DynamicImport{
+		ctx:       ctx,
+		specifier: C.GoString(specifier),
+		referrer:  C.GoString(referrer),
+		resolver:  resolver,
+	}
+	ctx.modMutex.Lock()
+	handler := ctx.importHandler
+	ctx.modMutex.Unlock()
+	if handler == nil {
+		imp.Reject(fmt.Errorf("Cannot import module '%s': dynamic import is not supported", imp.specifier))
+		return
+	}
+	handler(ctx, imp)
+}
+
+//export goImportMeta
+func goImportMeta(ctxref int, module C.ModulePtr, meta C.ValuePtr) {
+	ctx := getContext(ctxref)
+	if ctx == nil {
+		return
+	}
+	ctx.modMutex.Lock()
+	m := ctx.modulePtrs[module]
+	handler := ctx.importMetaHandler
+	ctx.modMutex.Unlock()
+	if m == nil {
+		return
+	}
+
+	obj := &Object{&Value{meta, ctx}}
+	obj.Set("url", m.name)
+	if handler != nil {
+		handler(m, obj)
+	}
+}
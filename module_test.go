@@ -0,0 +1,342 @@
+// Copyright 2023 the v8go contributors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+package v8go_test
+
+import (
+	"fmt"
+	"path"
+	"reflect"
+	"strings"
+	"testing"
+	"time"
+
+	v8 "github.com/ionos-cloud/v8go"
+)
+
+var moduleSources = map[string]string{
+	"/main.js":      "import { add } from './lib/math.js'; import * as util from './lib/util.js'; export const result = util.twice(add(1, 2));",
+	"/lib/math.js":  "export function add(a, b) { return a + b }",
+	"/lib/util.js":  "import { add } from './math.js'; export const twice = (x) => add(x, x);",
+	"/throws.js":    "throw new Error('boom')",
+	"/missing.js":   "import './nope.js'",
+	"/syntax.js":    "export const = 1",
+	"/top-level.js": "export let resolve; export const value = await new Promise((r) => { resolve = r })",
+	"/lazy.js":      "export async function load() { const util = await import('./lib/util.js'); return util.twice(5) }",
+	"/meta.js":      "export const url = import.meta.url; export const env = import.meta.env",
+}
+
+func resolveModule(ctx *v8.Context, specifier string, referrer *v8.Module) (*v8.Module, error) {
+	name := path.Join(path.Dir(referrer.Name()), specifier)
+	if m := ctx.Module(name); m != nil {
+		return m, nil
+	}
+	source, ok := moduleSources[name]
+	if !ok {
+		return nil, fmt.Errorf("module %s not found", name)
+	}
+	return ctx.CompileModule(source, name, v8.CompileOptions{})
+}
+
+func TestModule(t *testing.T) {
+	t.Parallel()
+
+	ctx := v8.NewContext()
+	defer ctx.Isolate().Dispose()
+	defer ctx.Close()
+
+	m, err := ctx.CompileModule(moduleSources["/main.js"], "/main.js", v8.CompileOptions{})
+	fatalIf(t, err)
+	if again, _ := ctx.CompileModule("", "/main.js", v8.CompileOptions{}); again != m {
+		t.Error("expected the module compiled under the same name")
+	}
+	if reqs := m.Requests(); !reflect.DeepEqual(reqs, []string{"./lib/math.js", "./lib/util.js"}) {
+		t.Errorf("unexpected requests %v", reqs)
+	}
+	if m.Status() != v8.ModuleUninstantiated {
+		t.Errorf("expected uninstantiated module, got %v", m.Status())
+	}
+	if _, err := m.Namespace(); err == nil {
+		t.Error("expected error getting the namespace of an uninstantiated module")
+	}
+
+	fatalIf(t, m.Instantiate(resolveModule))
+	if m.Status() != v8.ModuleInstantiated {
+		t.Errorf("expected instantiated module, got %v", m.Status())
+	}
+	if ctx.Module("/lib/math.js") == nil {
+		t.Error("expected imported modules to be kept by the context")
+	}
+	promise, err := m.Evaluate()
+	fatalIf(t, err)
+	if !promise.IsPromise() {
+		t.Errorf("expected evaluation to return a promise, got %v", promise)
+	}
+	if m.Status() != v8.ModuleEvaluated {
+		t.Errorf("expected evaluated module, got %v", m.Status())
+	}
+	ns, err := m.Namespace()
+	fatalIf(t, err)
+	if !ns.IsModuleNamespaceObject() {
+		t.Error("expected a module namespace object")
+	}
+	if result, _ := ns.Get("result"); result.Int32() != 6 {
+		t.Errorf("expected result 6, got %v", result)
+	}
+}
+
+func TestModuleErrors(t *testing.T) {
+	t.Parallel()
+
+	ctx := v8.NewContext()
+	defer ctx.Isolate().Dispose()
+	defer ctx.Close()
+
+	_, err := ctx.CompileModule(moduleSources["/syntax.js"], "/syntax.js", v8.CompileOptions{})
+	if e, ok := err.(*v8.JSError); !ok || !strings.Contains(e.Message, "SyntaxError") || !strings.HasPrefix(e.Location, "/syntax.js") {
+		t.Errorf("expected SyntaxError in /syntax.js, got %v", err)
+	}
+
+	m, err := ctx.CompileModule(moduleSources["/missing.js"], "/missing.js", v8.CompileOptions{})
+	fatalIf(t, err)
+	if err := m.Instantiate(resolveModule); err == nil || !strings.Contains(err.Error(), "module /nope.js not found") {
+		t.Errorf("expected resolve error, got %v", err)
+	}
+	if err := m.Instantiate(nil); err == nil || !strings.Contains(err.Error(), "Cannot find module './nope.js'") {
+		t.Errorf("expected error resolving without resolver, got %v", err)
+	}
+
+	m, err = ctx.CompileModule(moduleSources["/throws.js"], "/throws.js", v8.CompileOptions{})
+	fatalIf(t, err)
+	fatalIf(t, m.Instantiate(nil))
+	_, err = m.Evaluate()
+	if e, ok := err.(*v8.JSError); !ok || e.Message != "Error: boom" || !strings.Contains(e.StackTrace, "/throws.js") {
+		t.Errorf("expected Error: boom, got %v", err)
+	}
+	if m.Status() != v8.ModuleErrored {
+		t.Errorf("expected errored module, got %v", m.Status())
+	}
+
+	m, err = ctx.CompileModule(moduleSources["/top-level.js"], "/top-level.js", v8.CompileOptions{})
+	fatalIf(t, err)
+	fatalIf(t, m.Instantiate(nil))
+	val, err := m.Evaluate()
+	fatalIf(t, err)
+	promise, _ := val.AsPromise()
+	if promise.State() != v8.Pending {
+		t.Errorf("expected a pending promise for top-level await, got %v", promise.State())
+	}
+	ns, err := m.Namespace()
+	fatalIf(t, err)
+	resolve, _ := ns.Get("resolve")
+	fn, _ := resolve.AsFunction()
+	fn.Call(v8.Undefined(ctx.Isolate()))
+	if promise.State() != v8.Fulfilled || m.Status() != v8.ModuleEvaluated {
+		t.Errorf("expected evaluation to finish after the await, got %v", promise.State())
+	}
+}
+
+func TestModuleCodeCache(t *testing.T) {
+	t.Parallel()
+
+	ctx1 := v8.NewContext()
+	defer ctx1.Isolate().Dispose()
+	defer ctx1.Close()
+	m, err := ctx1.CompileModule(moduleSources["/lib/math.js"], "/lib/math.js", v8.CompileOptions{})
+	fatalIf(t, err)
+	cache, err := m.CreateCodeCache()
+	fatalIf(t, err)
+
+	ctx2 := v8.NewContext()
+	defer ctx2.Isolate().Dispose()
+	defer ctx2.Close()
+	opts := v8.CompileOptions{CachedData: cache}
+	m2, err := ctx2.CompileModule(moduleSources["/lib/math.js"], "/lib/math.js", opts)
+	fatalIf(t, err)
+	if cache.Rejected {
+		t.Error("expected module code cache to be accepted")
+	}
+	fatalIf(t, m2.Instantiate(nil))
+	_, err = m2.Evaluate()
+	fatalIf(t, err)
+	ns, _ := m2.Namespace()
+	add, _ := ns.Get("add")
+	fn, _ := add.AsFunction()
+	one, _ := v8.NewValue(ctx2.Isolate(), int32(1))
+	if sum, _ := fn.Call(v8.Undefined(ctx2.Isolate()), one, one); sum.Int32() != 2 {
+		t.Errorf("expected 2, got %v", sum)
+	}
+
+	if _, err := m2.CreateCodeCache(); err == nil {
+		t.Error("expected error creating a code cache for an evaluated module")
+	}
+}
+
+func TestModuleDynamicImport(t *testing.T) {
+	t.Parallel()
+
+	ctx := v8.NewContext()
+	defer ctx.Isolate().Dispose()
+	defer ctx.Close()
+
+	// without a handler, import() is rejected
+	val, err := ctx.RunScript("import('/lib/math.js')", "/script.js")
+	fatalIf(t, err)
+	ctx.PerformMicrotaskCheckpoint()
+	if p, _ := val.AsPromise(); p.State() != v8.Rejected || !strings.Contains(p.Result().String(), "dynamic import is not supported") {
+		t.Errorf("expected import() to be rejected without a handler, got %v", p.Result())
+	}
+
+	var pending []*v8.DynamicImport
+	ctx.SetDynamicImportHandler(func(ctx *v8.Context, imp *v8.DynamicImport) {
+		pending = append(pending, imp)
+	})
+	load := func(imp *v8.DynamicImport) {
+		name := path.Join(path.Dir(imp.Referrer()), imp.Specifier())
+		source, ok := moduleSources[name]
+		if !ok {
+			imp.Reject(fmt.Errorf("module %s not found", name))
+			return
+		}
+		m, err := ctx.CompileModule(source, name, v8.CompileOptions{})
+		if err != nil {
+			imp.Reject(err)
+			return
+		}
+		imp.Resolve(m, resolveModule)
+	}
+
+	m, err := ctx.CompileModule(moduleSources["/lazy.js"], "/lazy.js", v8.CompileOptions{})
+	fatalIf(t, err)
+	fatalIf(t, m.Instantiate(resolveModule))
+	_, err = m.Evaluate()
+	fatalIf(t, err)
+	if len(pending) != 0 || ctx.Module("/lib/util.js") != nil {
+		t.Fatal("expected the import to be lazy")
+	}
+
+	ns, _ := m.Namespace()
+	fn, _ := ns.MethodCall("load")
+	loaded, _ := fn.AsPromise()
+	if len(pending) != 1 || pending[0].Specifier() != "./lib/util.js" || pending[0].Referrer() != "/lazy.js" {
+		t.Fatalf("expected a pending import of ./lib/util.js from /lazy.js, got %v", pending)
+	}
+	// the module is loaded asynchronously, after the script has returned
+	if loaded.State() != v8.Pending {
+		t.Errorf("expected a pending promise, got %v", loaded.State())
+	}
+	load(pending[0])
+	ctx.PerformMicrotaskCheckpoint()
+	if loaded.State() != v8.Fulfilled || loaded.Result().Int32() != 10 {
+		t.Errorf("expected 10, got %v", loaded.Result())
+	}
+
+	pending = nil
+	val, err = ctx.RunScript(`Promise.allSettled([
+		import('./throws.js'),
+		import('./nope.js'),
+		import('./syntax.js'),
+		import('./lib/math.js').then((math) => math.add(1, 2)),
+	]).then((results) => results.map((r) => r.status == 'fulfilled' ? r.value : r.reason.message))`, "/script.js")
+	fatalIf(t, err)
+	for _, imp := range pending {
+		load(imp)
+	}
+	ctx.PerformMicrotaskCheckpoint()
+	p, _ := val.AsPromise()
+	results, _ := v8.JSONStringify(ctx, p.Result())
+	if results != `["boom","module /nope.js not found","SyntaxError: Unexpected token '='",3]` {
+		t.Errorf("unexpected results %s", results)
+	}
+}
+
+func TestModuleDynamicImportStatistics(t *testing.T) {
+	t.Parallel()
+
+	ctx := v8.NewContext()
+	defer ctx.Isolate().Dispose()
+	defer ctx.Close()
+
+	ctx.SetDynamicImportHandler(func(ctx *v8.Context, imp *v8.DynamicImport) {
+		time.Sleep(20 * time.Millisecond)
+		imp.Reject(fmt.Errorf("module %s not found", imp.Specifier()))
+	})
+	before := ctx.GetExecutionStatistics()
+	_, err := ctx.RunScript("import('/lib/math.js')", "/script.js")
+	fatalIf(t, err)
+	after := ctx.GetExecutionStatistics()
+	if n := after.Callbacks - before.Callbacks; n != 1 {
+		t.Errorf("expected the import handler to count as 1 callback, got %d", n)
+	}
+	if d := after.CallbackTime - before.CallbackTime; d < 20*time.Millisecond {
+		t.Errorf("expected the import handler to take 20ms, got %v", d)
+	}
+	if d := after.WallTime - before.WallTime; d < 20*time.Millisecond {
+		t.Errorf("expected the import handler to be part of the script, got %v", d)
+	}
+}
+
+func TestModuleImportMeta(t *testing.T) {
+	t.Parallel()
+
+	ctx := v8.NewContext()
+	defer ctx.Isolate().Dispose()
+	defer ctx.Close()
+
+	ctx.SetImportMetaHandler(func(m *v8.Module, meta *v8.Object) {
+		meta.Set("env", "test:"+m.Name())
+	})
+	m, err := ctx.CompileModule(moduleSources["/meta.js"], "/meta.js", v8.CompileOptions{})
+	fatalIf(t, err)
+	fatalIf(t, m.Instantiate(nil))
+	_, err = m.Evaluate()
+	fatalIf(t, err)
+	ns, _ := m.Namespace()
+	if url, _ := ns.Get("url"); url.String() != "/meta.js" {
+		t.Errorf("expected import.meta.url /meta.js, got %v", url)
+	}
+	if env, _ := ns.Get("env"); env.String() != "test:/meta.js" {
+		t.Errorf("expected import.meta.env from the handler, got %v", env)
+	}
+}
+
+func TestModuleClosedContext(t *testing.T) {
+	t.Parallel()
+
+	iso := v8.NewIsolate()
+	defer iso.Dispose()
+	ctx := v8.NewContext(iso)
+	defer ctx.Close()
+
+	// functions left behind by a closed context may still run in it
+	closed := v8.NewContext(iso, v8.MicrotaskQueue{Policy: v8.MicrotasksExplicit})
+	closed.SetDynamicImportHandler(func(ctx *v8.Context, imp *v8.DynamicImport) {
+		t.Error("unexpected import in a closed context")
+	})
+	m, err := closed.CompileModule(`
+		export const load = () => import('./lib/math.js');
+		export const meta = () => import.meta;`, "/closed.js", v8.CompileOptions{})
+	fatalIf(t, err)
+	fatalIf(t, m.Instantiate(nil))
+	_, err = m.Evaluate()
+	fatalIf(t, err)
+	ns, _ := m.Namespace()
+	fatalIf(t, ctx.Global().Set("closed", ns))
+	// an import still queued is dropped with the context
+	_, err = closed.RunScript("import('./lib/util.js')", "/pending.js")
+	fatalIf(t, err)
+	closed.Close()
+
+	val, err := ctx.RunScript("closed.load()", "/load.js")
+	fatalIf(t, err)
+	ctx.PerformMicrotaskCheckpoint()
+	if p, _ := val.AsPromise(); p.State() != v8.Rejected || !strings.Contains(p.Result().String(), "the context is closed") {
+		t.Errorf("expected import() to be rejected in a closed context, got %v", p.Result())
+	}
+	val, err = ctx.RunScript("Object.keys(closed.meta()).length", "/meta.js")
+	fatalIf(t, err)
+	if val.Int32() != 0 {
+		t.Errorf("expected an empty import.meta in a closed context, got %v", val)
+	}
+}
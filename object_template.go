@@ -57,7 +57,7 @@ func (o *ObjectTemplate) NewInstance(ctx *Context) (*Object, error) {
 	}
 
 	rtn := C.ObjectTemplateNewInstance(o.ptr, ctx.ptr)
-	runtime.KeepAlive(o)
+	ctx.retainTemplate(o.template)
 	return objectResult(ctx, rtn)
 }
 
@@ -9,7 +9,19 @@ package v8go
 import "C"
 
 import (
+	"context"
 	"errors"
+	"runtime"
+	"sync"
+	"sync/atomic"
+)
+
+// Promises being awaited are registered, so that the reaction V8 calls when
+// one of them is settled can wake up its Await.
+var (
+	awaitMutex sync.Mutex
+	awaiters   = make(map[int]chan struct{})
+	awaitSeq   = 0
 )
 
 // PromiseState is the state of the Promise.
@@ -21,6 +33,37 @@ const (
 	Rejected
 )
 
+// PromiseRejectEvent is the event a PromiseRejectCallback is called for.
+type PromiseRejectEvent int
+
+const (
+	// PromiseRejectWithNoHandler is a promise rejected without a handler.
+	PromiseRejectWithNoHandler PromiseRejectEvent = iota
+	// PromiseHandlerAddedAfterReject is a handler added to a promise rejected
+	// without a handler before, which makes that rejection handled.
+	PromiseHandlerAddedAfterReject
+	// PromiseRejectAfterResolved and PromiseResolveAfterResolved are calls
+	// to reject or resolve a promise that has already been resolved.
+	PromiseRejectAfterResolved
+	PromiseResolveAfterResolved
+)
+
+// PromiseRejectMessage describes a PromiseRejectEvent.
+type PromiseRejectMessage struct {
+	Event   PromiseRejectEvent
+	Promise *Promise
+	// Value is the rejection reason or resolution value, or nil for
+	// PromiseHandlerAddedAfterReject.
+	Value *Value
+}
+
+// PromiseRejectCallback is called by V8 when a promise is rejected without a
+// handler, and again if a handler is added later. Reporting the rejections
+// still unhandled after a microtask checkpoint, as browsers and Node.js do,
+// tracks unhandled rejections without adding a handler to every promise.
+// It is called synchronously from V8 and must not run JavaScript.
+type PromiseRejectCallback func(ctx *Context, msg PromiseRejectMessage)
+
 // PromiseResolver is the resolver object for the promise.
 // Most cases will create a new PromiseResolver and return
 // the associated Promise from the resolver.
@@ -63,12 +106,14 @@ func (r *PromiseResolver) GetPromise() *Promise {
 // Resolve invokes the Promise resolve state with the given value.
 // The Promise state will transition from Pending to Fulfilled.
 func (r *PromiseResolver) Resolve(val Valuer) bool {
+	defer r.ctx.iso.notifySettled()
 	return C.PromiseResolverResolve(r.ptr, val.value().ptr) != 0
 }
 
 // Reject invokes the Promise reject state with the given value.
 // The Promise state will transition from Pending to Rejected.
 func (r *PromiseResolver) Reject(err *Value) bool {
+	defer r.ctx.iso.notifySettled()
 	return C.PromiseResolverReject(r.ptr, err.ptr) != 0
 }
 
@@ -86,6 +131,145 @@ func (p *Promise) Result() *Value {
 	return val
 }
 
+// Await waits for the promise to settle, then returns the value it was
+// fulfilled with, or the reason it was rejected with as a `JSError`.
+//
+// Await runs the microtasks of the isolate itself, so a promise settled by
+// microtasks alone, like most async functions, is awaited in a single call
+// into V8. When the promise depends on work done elsewhere, such as a timer of
+// an EventLoop run from another goroutine or a PromiseResolver resolved from
+// Go, Await blocks until it is settled, without polling.
+//
+// Once ctx is done, Await returns ctx.Err(), terminating the microtasks it is
+// running, if any, with TerminateExecution.
+func (p *Promise) Await(ctx context.Context) (*Value, error) {
+	awaitMutex.Lock()
+	awaitSeq++
+	ref := awaitSeq
+	settled := make(chan struct{})
+	awaiters[ref] = settled
+	awaitMutex.Unlock()
+	defer func() {
+		awaitMutex.Lock()
+		delete(awaiters, ref)
+		awaitMutex.Unlock()
+	}()
+
+	for attach := ref; ; attach = 0 {
+		// taken before the checkpoint, so that a promise settled from Go
+		// while it runs is not missed
+		settledFromGo := p.ctx.iso.settledFromGo()
+		rtn, err := p.await(ctx, attach)
+		if err != nil {
+			return nil, err
+		}
+		if rtn.error.msg != nil {
+			return nil, newJSError(rtn.error)
+		}
+		if PromiseState(rtn.state) == Fulfilled {
+			return &Value{rtn.value, p.ctx}, nil
+		}
+
+		select {
+		case <-settled:
+		case <-settledFromGo:
+		case <-ctx.Done():
+			return nil, ctx.Err()
+		}
+	}
+}
+
+func (p *Promise) await(ctx context.Context, ref int) (C.RtnPromiseResult, error) {
+	if ctx.Done() == nil {
+		return C.PromiseAwait(p.ptr, C.int(ref)), nil
+	}
+
+	// the isolate is held until the termination is cancelled, so that it
+	// cannot hit the JavaScript of another goroutine entering the isolate
+	// once PromiseAwait returns, or while an interrupt yields, as
+	// withDeadline does
+	iso := p.ctx.iso
+	runtime.LockOSThread()
+	defer runtime.UnlockOSThread()
+	locker := C.IsolateLock(iso.ptr)
+	defer C.IsolateUnlock(locker)
+	atomic.AddInt32(&iso.terminable, 1)
+	defer atomic.AddInt32(&iso.terminable, -1)
+
+	var mu sync.Mutex
+	running, terminated := true, false
+	done := make(chan struct{})
+	go func() {
+		select {
+		case <-ctx.Done():
+			mu.Lock()
+			if running {
+				terminated = true
+				iso.TerminateExecution()
+			}
+			mu.Unlock()
+		case <-done:
+		}
+	}()
+
+	rtn := C.PromiseAwait(p.ptr, C.int(ref))
+	mu.Lock()
+	running = false
+	mu.Unlock()
+	close(done)
+	if terminated {
+		C.IsolateCancelTerminateExecution(iso.ptr)
+		return rtn, ctx.Err()
+	}
+	return rtn, nil
+}
+
+// SetPromiseRejectCallback sets the callback called for the promise rejection
+// events of all contexts of the isolate. Passing nil removes it.
+func (i *Isolate) SetPromiseRejectCallback(cb PromiseRejectCallback) {
+	i.cbMutex.Lock()
+	i.rejectCallback = cb
+	i.cbMutex.Unlock()
+	enabled := 0
+	if cb != nil {
+		enabled = 1
+	}
+	C.IsolateSetPromiseRejectCallback(i.ptr, C.int(enabled))
+}
+
+//export goPromiseReject
+func goPromiseReject(ctxref int, event C.int, promise C.ValuePtr, value C.ValuePtr) {
+	ctx := getContext(ctxref)
+	if ctx == nil {
+		return
+	}
+	ctx.iso.cbMutex.RLock()
+	cb := ctx.iso.rejectCallback
+	ctx.iso.cbMutex.RUnlock()
+	if cb == nil {
+		return
+	}
+
+	msg := PromiseRejectMessage{
+		Event:   PromiseRejectEvent(event),
+		Promise: &Promise{&Object{&Value{promise, ctx}}},
+	}
+	if value != nil {
+		msg.Value = &Value{value, ctx}
+	}
+	cb(ctx, msg)
+}
+
+//export goPromiseSettled
+func goPromiseSettled(ref int) {
+	awaitMutex.Lock()
+	defer awaitMutex.Unlock()
+	if settled, ok := awaiters[ref]; ok {
+		close(settled)
+		delete(awaiters, ref)
+	}
+}
+
 // Then accepts 1 or 2 callbacks.
 // The first is invoked when the promise has been fulfilled.
 // The second is invoked when the promise has been rejected.
@@ -94,35 +278,50 @@ func (p *Promise) Result() *Value {
 // V8 only invokes the callback when processing "microtasks".
 // The default MicrotaskPolicy processes them when the call depth decreases to 0.
 // Call (*Context).PerformMicrotaskCheckpoint to trigger it manually.
+// The callbacks are released once the promise is settled, whichever way it is
+// settled.
 func (p *Promise) Then(cbs ...FunctionCallback) *Promise {
-	var rtn C.RtnValue
 	switch len(cbs) {
 	case 1:
-		cbID := p.ctx.iso.registerCallback(cbs[0])
-		rtn = C.PromiseThen(p.ptr, C.int(cbID))
+		return p.then(cbs[0], rethrowReason)
 	case 2:
-		cbID1 := p.ctx.iso.registerCallback(cbs[0])
-		cbID2 := p.ctx.iso.registerCallback(cbs[1])
-		rtn = C.PromiseThen2(p.ptr, C.int(cbID1), C.int(cbID2))
-
+		return p.then(cbs[0], cbs[1])
 	default:
 		panic("1 or 2 callbacks required")
 	}
-	obj, err := objectResult(p.ctx, rtn)
-	if err != nil {
-		panic(err) // TODO: Return error
-	}
-	return &Promise{obj}
 }
 
 // Catch invokes the given function if the promise is rejected.
 // See Then for other details.
 func (p *Promise) Catch(cb FunctionCallback) *Promise {
-	cbID := p.ctx.iso.registerCallback(cb)
-	rtn := C.PromiseCatch(p.ptr, C.int(cbID))
+	return p.then(passValue, cb)
+}
+
+// then attaches both reactions of the promise as one group of callbacks,
+// which is unregistered as the promise settles and V8 calls either of them.
+func (p *Promise) then(onFulfilled, onRejected FunctionCallback) *Promise {
+	cbIDs := p.ctx.iso.registerOneShotCallbacks(onFulfilled, onRejected)
+	rtn := C.PromiseThen2(p.ptr, C.int(cbIDs[0]), C.int(cbIDs[1]))
 	obj, err := objectResult(p.ctx, rtn)
 	if err != nil {
 		panic(err) // TODO: Return error
 	}
 	return &Promise{obj}
 }
+
+// passValue and rethrowReason stand in for the reaction a Then or Catch leaves
+// out, settling the returned promise the way the original promise was.
+func passValue(info *FunctionCallbackInfo) *Value {
+	if args := info.Args(); len(args) > 0 {
+		return args[0]
+	}
+	return nil
+}
+
+func rethrowReason(info *FunctionCallbackInfo) *Value {
+	reason := Undefined(info.Context().iso)
+	if args := info.Args(); len(args) > 0 {
+		reason = args[0]
+	}
+	return info.Context().iso.ThrowException(reason)
+}
@@ -5,7 +5,11 @@
 package v8go_test
 
 import (
+	"context"
+	"strings"
+	"sync"
 	"testing"
+	"time"
 
 	v8 "github.com/ionos-cloud/v8go"
 )
@@ -110,6 +114,131 @@ func TestPromiseRejected(t *testing.T) {
 	}
 }
 
+func TestPromiseThenReleasesCallbacks(t *testing.T) {
+	t.Parallel()
+
+	iso := v8.NewIsolate()
+	defer iso.Dispose()
+	ctx := v8.NewContext(iso)
+	defer ctx.Close()
+	base := iso.CallbackCount()
+
+	calls := 0
+	cb := func(info *v8.FunctionCallbackInfo) *v8.Value {
+		calls++
+		return nil
+	}
+	for i := 0; i < 100; i++ {
+		res, _ := v8.NewPromiseResolver(ctx)
+		prom := res.GetPromise()
+		prom.Then(cb, cb)
+		prom.Catch(cb)
+		if i%2 == 0 {
+			res.Resolve(v8.Undefined(iso))
+		} else {
+			res.Reject(v8.Undefined(iso))
+		}
+	}
+	ctx.PerformMicrotaskCheckpoint()
+	if calls != 150 {
+		t.Errorf("expected 150 calls, got %d", calls)
+	}
+	// including the Catch callbacks of fulfilled promises, which are never called
+	if n := iso.CallbackCount() - base; n != 0 {
+		t.Errorf("expected the called callbacks to be unregistered, %d left", n)
+	}
+}
+
+func TestPromiseThenPassesThrough(t *testing.T) {
+	t.Parallel()
+
+	iso := v8.NewIsolate()
+	defer iso.Dispose()
+	ctx := v8.NewContext(iso)
+	defer ctx.Close()
+
+	cb := func(info *v8.FunctionCallbackInfo) *v8.Value {
+		t.Error("unexpected call")
+		return nil
+	}
+	val, _ := v8.NewValue(iso, "value")
+	res1, _ := v8.NewPromiseResolver(ctx)
+	caught := res1.GetPromise().Catch(cb)
+	res1.Resolve(val)
+	res2, _ := v8.NewPromiseResolver(ctx)
+	then := res2.GetPromise().Then(cb)
+	res2.Reject(val)
+	ctx.PerformMicrotaskCheckpoint()
+
+	if s := caught.State(); s != v8.Fulfilled || caught.Result().String() != "value" {
+		t.Errorf("expected Catch to pass the value through, got %v %v", s, caught.Result())
+	}
+	if s := then.State(); s != v8.Rejected || then.Result().String() != "value" {
+		t.Errorf("expected Then to pass the reason through, got %v %v", s, then.Result())
+	}
+}
+
+func TestPromiseRejectCallback(t *testing.T) {
+	t.Parallel()
+
+	iso := v8.NewIsolate()
+	defer iso.Dispose()
+	ctx := v8.NewContext(iso)
+	defer ctx.Close()
+
+	// promises rejected without a handler and not handled later
+	unhandled := map[*v8.Context][]*v8.PromiseRejectMessage{}
+	iso.SetPromiseRejectCallback(func(ctx *v8.Context, msg v8.PromiseRejectMessage) {
+		switch msg.Event {
+		case v8.PromiseRejectWithNoHandler:
+			unhandled[ctx] = append(unhandled[ctx], &msg)
+		case v8.PromiseHandlerAddedAfterReject:
+			for i, m := range unhandled[ctx] {
+				if m.Promise.SameValue(msg.Promise.Value) {
+					unhandled[ctx] = append(unhandled[ctx][:i], unhandled[ctx][i+1:]...)
+				}
+			}
+		}
+	})
+
+	_, err := ctx.RunScript(`
+		Promise.reject(new Error('unhandled'));
+		const handled = Promise.reject(new Error('handled'));
+		handled.catch(() => {});
+		(async () => { throw new Error('async') })();`, "reject.js")
+	fatalIf(t, err)
+	ctx.PerformMicrotaskCheckpoint()
+	var reasons []string
+	for _, msg := range unhandled[ctx] {
+		if msg.Promise.State() != v8.Rejected {
+			t.Errorf("expected a rejected promise, got %v", msg.Promise.State())
+		}
+		reasons = append(reasons, msg.Value.String())
+	}
+	if strings.Join(reasons, ", ") != "Error: unhandled, Error: async" {
+		t.Errorf("unexpected unhandled rejections %v", reasons)
+	}
+
+	iso.SetPromiseRejectCallback(nil)
+	_, err = ctx.RunScript("Promise.reject(new Error('ignored'))", "ignored.js")
+	fatalIf(t, err)
+	if len(unhandled[ctx]) != 2 {
+		t.Errorf("expected no call after removing the callback, got %d rejections", len(unhandled[ctx]))
+	}
+
+	// rejections in a context already closed on the Go side are not reported
+	closed := v8.NewContext(iso)
+	fn, err := closed.RunScript("() => Promise.reject(new Error('closed'))", "closed.js")
+	fatalIf(t, err)
+	fatalIf(t, ctx.Global().Set("reject", fn))
+	closed.Close()
+	iso.SetPromiseRejectCallback(func(ctx *v8.Context, msg v8.PromiseRejectMessage) {
+		t.Errorf("unexpected rejection event in %v", ctx)
+	})
+	_, err = ctx.RunScript("reject()", "reject.js")
+	fatalIf(t, err)
+}
+
 func TestPromiseThenPanic(t *testing.T) {
 	t.Parallel()
 
@@ -133,3 +262,163 @@ func TestPromiseThenPanic(t *testing.T) {
 		t.Errorf("expected a panic")
 	})
 }
+
+func TestPromiseAwait(t *testing.T) {
+	t.Parallel()
+
+	iso := v8.NewIsolate()
+	defer iso.Dispose()
+	ctx := v8.NewContext(iso)
+	defer ctx.Close()
+	background := context.Background()
+
+	await := func(source string) (*v8.Value, error) {
+		val, err := ctx.RunScript(source, "await.js")
+		fatalIf(t, err)
+		p, err := val.AsPromise()
+		fatalIf(t, err)
+		return p.Await(background)
+	}
+	if val, err := await("(async () => { await null; return 42 })()"); err != nil || val.Int32() != 42 {
+		t.Errorf("expected 42, got %v (%v)", val, err)
+	}
+	_, err := await("(async () => { throw new Error('nope') })()")
+	if e, ok := err.(*v8.JSError); !ok || e.Message != "Error: nope" || !strings.Contains(e.StackTrace, "await.js") {
+		t.Errorf("expected Error: nope, got %v", err)
+	}
+
+	// settled from Go by another goroutine
+	res, _ := v8.NewPromiseResolver(ctx)
+	go func() {
+		time.Sleep(10 * time.Millisecond)
+		val, _ := v8.NewValue(iso, "resolved")
+		res.Resolve(val)
+	}()
+	if val, err := res.GetPromise().Await(background); err != nil || val.String() != "resolved" {
+		t.Errorf("expected resolved, got %v (%v)", val, err)
+	}
+
+	// settled by an event loop run by another goroutine
+	loop := v8.NewEventLoop(ctx)
+	val, err := ctx.RunScript("new Promise((resolve) => setTimeout(() => resolve('timer'), 10))", "timer.js")
+	fatalIf(t, err)
+	go loop.Run(background)
+	p, _ := val.AsPromise()
+	if val, err := p.Await(background); err != nil || val.String() != "timer" {
+		t.Errorf("expected timer, got %v (%v)", val, err)
+	}
+
+	val, err = ctx.RunScript("new Promise(() => {})", "pending.js")
+	fatalIf(t, err)
+	p, _ = val.AsPromise()
+	timeout, cancel := context.WithTimeout(background, 10*time.Millisecond)
+	defer cancel()
+	if _, err := p.Await(timeout); err != context.DeadlineExceeded {
+		t.Errorf("expected the deadline to stop waiting, got %v", err)
+	}
+	if val, err := ctx.RunScript("'still usable'", "after.js"); err != nil || val.String() != "still usable" {
+		t.Errorf("expected the isolate to be usable after cancelling, got %v (%v)", val, err)
+	}
+
+	// endless microtasks are terminated
+	spinning := v8.NewContext(iso, v8.MicrotaskQueue{Policy: v8.MicrotasksExplicit})
+	defer spinning.Close()
+	val, err = spinning.RunScript("(function spin() { Promise.resolve().then(spin) })(); new Promise(() => {})", "spin.js")
+	fatalIf(t, err)
+	p, _ = val.AsPromise()
+	timeout, cancel = context.WithTimeout(background, 20*time.Millisecond)
+	defer cancel()
+	if _, err := p.Await(timeout); err != context.DeadlineExceeded {
+		t.Errorf("expected the deadline to terminate the microtasks, got %v", err)
+	}
+	if val, err := spinning.RunScript("'still usable'", "after.js"); err != nil || val.String() != "still usable" {
+		t.Errorf("expected the isolate to be usable after terminating, got %v (%v)", val, err)
+	}
+}
+
+func TestPromiseAwaitTerminationIsolated(t *testing.T) {
+	t.Parallel()
+
+	iso := v8.NewIsolate()
+	defer iso.Dispose()
+	spinning := v8.NewContext(iso, v8.MicrotaskQueue{Policy: v8.MicrotasksExplicit})
+	defer spinning.Close()
+	other := v8.NewContext(iso)
+	defer other.Close()
+
+	// the terminations of Await never hit the scripts of other goroutines
+	done := make(chan struct{})
+	go func() {
+		defer close(done)
+		for i := 0; i < 20; i++ {
+			val, err := spinning.RunScript("(function spin() { Promise.resolve().then(spin) })(); new Promise(() => {})", "spin.js")
+			if err != nil {
+				t.Error(err)
+				return
+			}
+			p, _ := val.AsPromise()
+			timeout, cancel := context.WithTimeout(context.Background(), 2*time.Millisecond)
+			if _, err := p.Await(timeout); err != context.DeadlineExceeded {
+				t.Errorf("expected the deadline to terminate the microtasks, got %v", err)
+			}
+			cancel()
+		}
+	}()
+	for {
+		select {
+		case <-done:
+			return
+		default:
+		}
+		if _, err := other.RunScript("for (let i = 0; i < 1000; i++) {}", "other.js"); err != nil {
+			t.Fatalf("expected other scripts not to be terminated, got %v", err)
+		}
+	}
+}
+
+func TestPromiseAwaitWithTimeSlicer(t *testing.T) {
+	t.Parallel()
+
+	iso := v8.NewIsolate()
+	defer iso.Dispose()
+	spinning := v8.NewContext(iso, v8.MicrotaskQueue{Policy: v8.MicrotasksExplicit})
+	defer spinning.Close()
+	other := v8.NewContext(iso)
+	defer other.Close()
+	slicer := v8.NewTimeSlicer(iso, 5*time.Millisecond)
+
+	// the slice of Await ends while the other tenant waits, but the isolate
+	// is not yielded to it before the cancellation of Await is done
+	var wg sync.WaitGroup
+	wg.Add(2)
+	go func() {
+		defer wg.Done()
+		slicer.Run(func() {
+			val, err := spinning.RunScript("(function spin() { Promise.resolve().then(spin) })(); new Promise(() => {})", "spin.js")
+			if err != nil {
+				t.Error(err)
+				return
+			}
+			p, _ := val.AsPromise()
+			timeout, cancel := context.WithTimeout(context.Background(), 50*time.Millisecond)
+			defer cancel()
+			if _, err := p.Await(timeout); err != context.DeadlineExceeded {
+				t.Errorf("expected the deadline to terminate the microtasks, got %v", err)
+			}
+		})
+	}()
+	go func() {
+		defer wg.Done()
+		time.Sleep(10 * time.Millisecond)
+		slicer.Run(func() {
+			_, err := other.RunScript(`{
+				const start = Date.now();
+				while (Date.now() - start < 80) {}
+			}`, "other.js")
+			if err != nil {
+				t.Errorf("expected the other tenant not to be terminated, got %v", err)
+			}
+		})
+	}()
+	wg.Wait()
+}
@@ -0,0 +1,215 @@
+// Copyright 2023 the v8go contributors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+package v8go
+
+import (
+	"container/list"
+	"runtime"
+	"sync"
+	"time"
+)
+
+// ScriptCache shares compiled scripts between the isolates of a process. The
+// first isolate to compile a script produces a code cache for it, which every
+// other isolate then compiles from, so that a pool of isolates parses and
+// compiles each script once rather than once per isolate. Concurrent
+// compilations of the same script wait for the first one instead of compiling
+// it too. A ScriptCache is safe for concurrent use.
+//
+// The code caches kept are bounded by a number of bytes, past which the least
+// recently used ones are dropped.
+type ScriptCache struct {
+	mu       sync.Mutex
+	maxBytes int64
+	entries  map[scriptCacheKey]*scriptCacheEntry
+	// the cached entries, most recently used first
+	lru   *list.List
+	stats ScriptCacheStats
+}
+
+// ScriptCacheStats counts the compilations of a ScriptCache.
+type ScriptCacheStats struct {
+	// Compiles counts the scripts compiled without a code cache.
+	Compiles uint64
+	// Hits counts the scripts compiled from a code cache, and Deduplicated
+	// those of them that waited for a concurrent compilation.
+	Hits         uint64
+	Deduplicated uint64
+	// Rejections counts the code caches V8 rejected, in which case the
+	// script was compiled without it, and its code cache replaced the
+	// rejected one.
+	Rejections uint64
+	// CompileTimeSaved estimates the time saved by the hits, from how much
+	// longer the first compilation of each script took.
+	CompileTimeSaved time.Duration
+	Entries          int
+	Bytes            int64
+}
+
+type scriptCacheKey struct {
+	key    string
+	origin string
+}
+
+type scriptCacheEntry struct {
+	key         scriptCacheKey
+	ready       chan struct{}
+	data        *CodeCacheData
+	compileTime time.Duration
+	// the element of the entry in the LRU list, while it is cached
+	elem *list.Element
+}
+
+// NewScriptCache creates an empty ScriptCache, keeping up to maxBytes bytes of
+// code caches. A maxBytes of 0 or less leaves the cache unbounded.
+func NewScriptCache(maxBytes int64) *ScriptCache {
+	return &ScriptCache{
+		maxBytes: maxBytes,
+		entries:  make(map[scriptCacheKey]*scriptCacheEntry),
+		lru:      list.New(),
+	}
+}
+
+// Compile compiles the script in the isolate like CompileUnboundScript,
+// using the code cache of an earlier compilation of the same source and origin
+// in any isolate. error will be of type `JSError` if not nil.
+func (c *ScriptCache) Compile(iso *Isolate, source, origin string) (*UnboundScript, error) {
+	key := scriptCacheKey{CodeCacheKey(source), origin}
+
+	c.mu.Lock()
+	e, ok := c.entries[key]
+	if !ok {
+		e = &scriptCacheEntry{key: key, ready: make(chan struct{})}
+		c.entries[key] = e
+		c.mu.Unlock()
+		return c.compileFirst(iso, source, origin, key, e)
+	}
+	c.mu.Unlock()
+
+	deduplicated := false
+	select {
+	case <-e.ready:
+	default:
+		deduplicated = true
+		<-e.ready
+	}
+	if e.data == nil {
+		// the first compilation failed, so this one will too
+		return iso.CompileUnboundScript(source, origin, CompileOptions{})
+	}
+
+	start := time.Now()
+	opts := CompileOptions{CachedData: &CompilerCachedData{Bytes: e.data.Bytes()}}
+	us, err := iso.CompileUnboundScript(source, origin, opts)
+	elapsed := time.Since(start)
+	runtime.KeepAlive(e.data)
+	if err != nil {
+		return nil, err
+	}
+
+	if opts.CachedData.Rejected {
+		// replace the rejected code cache rather than have every later
+		// compilation pay for the rejection too
+		fresh := &scriptCacheEntry{
+			key:         key,
+			ready:       make(chan struct{}),
+			data:        us.CreateCodeCacheData(),
+			compileTime: elapsed,
+		}
+		close(fresh.ready)
+		c.mu.Lock()
+		defer c.mu.Unlock()
+		c.stats.Rejections++
+		if c.entries[key] == e {
+			c.remove(e)
+			c.entries[key] = fresh
+			c.add(fresh)
+		}
+		return us, nil
+	}
+
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	if e.elem != nil {
+		c.lru.MoveToFront(e.elem)
+	}
+	c.stats.Hits++
+	if deduplicated {
+		c.stats.Deduplicated++
+	}
+	if saved := e.compileTime - elapsed; saved > 0 {
+		c.stats.CompileTimeSaved += saved
+	}
+	return us, nil
+}
+
+func (c *ScriptCache) compileFirst(iso *Isolate, source, origin string, key scriptCacheKey, e *scriptCacheEntry) (*UnboundScript, error) {
+	defer close(e.ready)
+
+	start := time.Now()
+	us, err := iso.CompileUnboundScript(source, origin, CompileOptions{})
+	e.compileTime = time.Since(start)
+	if err == nil {
+		e.data = us.CreateCodeCacheData()
+	}
+
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	c.stats.Compiles++
+	if c.entries[key] != e {
+		// cleared in the meantime
+		return us, err
+	}
+	if err != nil {
+		delete(c.entries, key)
+		return nil, err
+	}
+	c.add(e)
+	return us, nil
+}
+
+// add caches the entry, which is in c.entries, dropping the least recently
+// used entries past the size limit.
+func (c *ScriptCache) add(e *scriptCacheEntry) {
+	e.elem = c.lru.PushFront(e)
+	c.stats.Entries++
+	c.stats.Bytes += int64(len(e.data.Bytes()))
+	for c.maxBytes > 0 && c.stats.Bytes > c.maxBytes {
+		c.remove(c.lru.Back().Value.(*scriptCacheEntry))
+	}
+}
+
+// remove drops a cached entry. Its code cache is freed once no compilation
+// uses it anymore.
+func (c *ScriptCache) remove(e *scriptCacheEntry) {
+	if c.entries[e.key] == e {
+		delete(c.entries, e.key)
+	}
+	c.lru.Remove(e.elem)
+	e.elem = nil
+	c.stats.Entries--
+	c.stats.Bytes -= int64(len(e.data.Bytes()))
+}
+
+// Stats returns the counters of the cache.
+func (c *ScriptCache) Stats() ScriptCacheStats {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	return c.stats
+}
+
+// Clear removes all code caches from the cache. Their memory is freed once no
+// compilation uses them anymore.
+func (c *ScriptCache) Clear() {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	c.entries = make(map[scriptCacheKey]*scriptCacheEntry)
+	for el := c.lru.Front(); el != nil; el = el.Next() {
+		el.Value.(*scriptCacheEntry).elem = nil
+	}
+	c.lru.Init()
+	c.stats.Entries = 0
+	c.stats.Bytes = 0
+}
@@ -0,0 +1,128 @@
+// Copyright 2023 the v8go contributors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+package v8go_test
+
+import (
+	"fmt"
+	"strings"
+	"sync"
+	"testing"
+
+	v8 "github.com/ionos-cloud/v8go"
+)
+
+func TestScriptCache(t *testing.T) {
+	t.Parallel()
+
+	var src strings.Builder
+	for i := 0; i < 500; i++ {
+		fmt.Fprintf(&src, "function f%d(x) { return x + %d }\n", i, i)
+	}
+	src.WriteString("f499(1)")
+	cache := v8.NewScriptCache(0)
+
+	const isolates = 8
+	var wg sync.WaitGroup
+	for i := 0; i < isolates; i++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			iso := v8.NewIsolate()
+			defer iso.Dispose()
+			us, err := cache.Compile(iso, src.String(), "bundle.js")
+			if err != nil {
+				t.Error(err)
+				return
+			}
+			ctx := v8.NewContext(iso)
+			defer ctx.Close()
+			if val, err := us.Run(ctx); err != nil || val.Int32() != 500 {
+				t.Errorf("expected 500, got %v (%v)", val, err)
+			}
+		}()
+	}
+	wg.Wait()
+
+	s := cache.Stats()
+	if s.Compiles != 1 || s.Hits != isolates-1 || s.Rejections != 0 {
+		t.Errorf("expected one compilation and %d hits, got %+v", isolates-1, s)
+	}
+	if s.Entries != 1 || s.Bytes == 0 {
+		t.Errorf("expected one code cache, got %+v", s)
+	}
+
+	// the origin is part of the key
+	iso := v8.NewIsolate()
+	defer iso.Dispose()
+	_, err := cache.Compile(iso, src.String(), "other.js")
+	fatalIf(t, err)
+	if s := cache.Stats(); s.Compiles != 2 || s.Entries != 2 {
+		t.Errorf("expected a second compilation for another origin, got %+v", s)
+	}
+
+	for i := 0; i < 2; i++ {
+		if _, err := cache.Compile(iso, "let x = ;", "bad.js"); err == nil {
+			t.Error("expected error compiling invalid script")
+		}
+	}
+	if s := cache.Stats(); s.Entries != 2 {
+		t.Errorf("expected failed compilations not to be cached, got %+v", s)
+	}
+
+	cache.Clear()
+	if s := cache.Stats(); s.Entries != 0 || s.Bytes != 0 {
+		t.Errorf("expected an empty cache, got %+v", s)
+	}
+}
+
+func TestScriptCacheRejection(t *testing.T) {
+	t.Parallel()
+
+	iso := v8.NewIsolate()
+	defer iso.Dispose()
+	cache := v8.NewScriptCache(0)
+
+	// the code cache of another source is rejected
+	other, err := iso.CompileUnboundScript("'other'", "other.js", v8.CompileOptions{})
+	fatalIf(t, err)
+	cache.SetCodeCache("'script'", "script.js", other.CreateCodeCacheData())
+	for i := 0; i < 3; i++ {
+		_, err := cache.Compile(iso, "'script'", "script.js")
+		fatalIf(t, err)
+	}
+	if s := cache.Stats(); s.Rejections != 1 || s.Hits != 2 || s.Entries != 1 {
+		t.Errorf("expected the rejected code cache to be replaced, got %+v", s)
+	}
+}
+
+func TestScriptCacheMaxBytes(t *testing.T) {
+	t.Parallel()
+
+	iso := v8.NewIsolate()
+	defer iso.Dispose()
+	source := func(i int) string { return fmt.Sprintf("function f() { return %d }", i) }
+	us, err := iso.CompileUnboundScript(source(0), "size.js", v8.CompileOptions{})
+	fatalIf(t, err)
+	size := int64(len(us.CreateCodeCache().Bytes))
+
+	// room for two code caches of about the same size
+	cache := v8.NewScriptCache(size*2 + size/2)
+	for _, i := range []int{1, 2, 1, 3} {
+		_, err := cache.Compile(iso, source(i), "size.js")
+		fatalIf(t, err)
+	}
+	s := cache.Stats()
+	if s.Entries != 2 || s.Bytes > size*2+size/2 {
+		t.Errorf("expected two code caches, got %+v", s)
+	}
+	// 2 was the least recently used
+	for _, i := range []int{1, 3, 2} {
+		_, err := cache.Compile(iso, source(i), "size.js")
+		fatalIf(t, err)
+	}
+	if s := cache.Stats(); s.Compiles != 4 || s.Hits != 3 {
+		t.Errorf("expected the least recently used code cache to be dropped, got %+v", s)
+	}
+}
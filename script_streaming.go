@@ -0,0 +1,215 @@
+// Copyright 2023 the v8go contributors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+package v8go
+
+// #include <stdlib.h>
+// #include "v8go.h"
+import "C"
+
+import (
+	"io"
+	"sync"
+	"unsafe"
+)
+
+// ScriptCompileTask is a script being compiled in the background, started by
+// CompileUnboundScriptInBackground.
+type ScriptCompileTask struct {
+	iso    *Isolate
+	ptr    C.StreamingCompilePtr
+	origin string
+	done   chan struct{}
+
+	once sync.Once
+	us   *UnboundScript
+	err  error
+}
+
+// CompileUnboundScriptInBackground compiles the source on a separate thread,
+// rather than while holding the isolate like CompileUnboundScript does, so the
+// isolate keeps running other scripts in the meantime. Only preparing the
+// compilation and creating the script from its result, done by Result, need
+// the isolate.
+//
+// Result must be called to obtain the script and free the compilation, and
+// before the isolate is disposed.
+func (i *Isolate) CompileUnboundScriptInBackground(source, origin string) *ScriptCompileTask {
+	cSource := C.CString(source)
+	defer C.free(unsafe.Pointer(cSource))
+
+	t := &ScriptCompileTask{
+		iso:    i,
+		ptr:    C.IsolateStartStreamingCompile(i.ptr, cSource, C.int(len(source))),
+		origin: origin,
+		done:   make(chan struct{}),
+	}
+	go func() {
+		C.StreamingCompileRun(t.ptr)
+		close(t.done)
+	}()
+	return t
+}
+
+// Done returns a channel that is closed once the background compilation has
+// finished, after which Result returns without waiting.
+func (t *ScriptCompileTask) Done() <-chan struct{} {
+	return t.done
+}
+
+// Result waits for the background compilation and creates the compiled script
+// in the isolate. It may be called any number of times and returns the same
+// result each time. error will be of type `JSError` if not nil.
+func (t *ScriptCompileTask) Result() (*UnboundScript, error) {
+	<-t.done
+	t.once.Do(func() {
+		t.iso.releasePendingScripts()
+		cOrigin := C.CString(t.origin)
+		defer C.free(unsafe.Pointer(cOrigin))
+
+		rtn := C.StreamingCompileFinish(t.iso.ptr, t.ptr, cOrigin)
+		t.ptr = nil
+		if rtn.ptr == nil {
+			t.err = newJSError(rtn.error)
+			return
+		}
+		t.us = newUnboundScript(t.iso, rtn.ptr)
+	})
+	return t.us, t.err
+}
+
+// CompileUnboundScriptFromReader compiles the UTF-8 source read from r, parsing
+// each chunk as it arrives so that reading and compiling overlap: r is read
+// ahead by another goroutine, a few chunks at most, while the compiler parses
+// the chunks already read. As with
+// CompileUnboundScriptInBackground, this happens without holding the isolate.
+// Only a single copy of the source is kept, which V8 needs to create the
+// script, and for ASCII sources the script's source string uses it rather than
+// a copy of its own.
+// error is the error from r if reading failed, or else of type `JSError`.
+func (i *Isolate) CompileUnboundScriptFromReader(r io.Reader, origin string) (*UnboundScript, error) {
+	sr := newSourceReader(r)
+	ref := registerSourceReader(sr)
+	defer unregisterSourceReader(ref)
+
+	t := &ScriptCompileTask{
+		iso:    i,
+		ptr:    C.IsolateStartStreamingCompileReader(i.ptr, C.int(ref)),
+		origin: origin,
+		done:   make(chan struct{}),
+	}
+	C.StreamingCompileRun(t.ptr)
+	close(t.done)
+	us, err := t.Result()
+	if err := sr.stop(); err != nil {
+		return nil, err
+	}
+	return us, err
+}
+
+// The source is read in chunks of sourceReaderChunkSize bytes, at most
+// sourceReaderChunks of them ahead of the compiler.
+const (
+	sourceReaderChunks    = 4
+	sourceReaderChunkSize = 64 << 10
+)
+
+// sourceReader reads the source in a goroutine of its own, handing the chunks
+// to goReadSource through a bounded channel.
+type sourceReader struct {
+	r       io.Reader
+	chunks  chan []byte
+	pending []byte
+	quit    chan struct{}
+	done    chan struct{}
+	err     error
+}
+
+func newSourceReader(r io.Reader) *sourceReader {
+	sr := &sourceReader{
+		r:      r,
+		chunks: make(chan []byte, sourceReaderChunks),
+		quit:   make(chan struct{}),
+		done:   make(chan struct{}),
+	}
+	go sr.readAhead()
+	return sr
+}
+
+func (sr *sourceReader) readAhead() {
+	defer close(sr.done)
+	defer close(sr.chunks)
+	for {
+		chunk := make([]byte, sourceReaderChunkSize)
+		n, err := sr.r.Read(chunk)
+		if n > 0 {
+			select {
+			case sr.chunks <- chunk[:n]:
+			case <-sr.quit:
+				return
+			}
+		}
+		if err == io.EOF {
+			return
+		}
+		if err != nil {
+			sr.err = err
+			return
+		}
+	}
+}
+
+// stop ends the reading once the compiler is done with the source, and
+// returns the error of the reader, if any.
+func (sr *sourceReader) stop() error {
+	close(sr.quit)
+	<-sr.done
+	return sr.err
+}
+
+// read copies the next chunk, or what is left of it, into p, returning 0 at
+// the end of the source or after a read error.
+func (sr *sourceReader) read(p []byte) int {
+	if len(sr.pending) == 0 {
+		chunk, ok := <-sr.chunks
+		if !ok {
+			return 0
+		}
+		sr.pending = chunk
+	}
+	n := copy(p, sr.pending)
+	sr.pending = sr.pending[n:]
+	return n
+}
+
+var (
+	sourceReaderMutex sync.Mutex
+	sourceReaderSeq   int
+	sourceReaders     = make(map[int]*sourceReader)
+)
+
+func registerSourceReader(sr *sourceReader) int {
+	sourceReaderMutex.Lock()
+	defer sourceReaderMutex.Unlock()
+	sourceReaderSeq++
+	sourceReaders[sourceReaderSeq] = sr
+	return sourceReaderSeq
+}
+
+func unregisterSourceReader(ref int) {
+	sourceReaderMutex.Lock()
+	defer sourceReaderMutex.Unlock()
+	delete(sourceReaders, ref)
+}
+
+//export goReadSource
+func goReadSource(ref int, buf unsafe.Pointer, size int) int {
+	sourceReaderMutex.Lock()
+	sr := sourceReaders[ref]
+	sourceReaderMutex.Unlock()
+	if sr == nil {
+		return 0
+	}
+	return sr.read(unsafe.Slice((*byte)(buf), size))
+}
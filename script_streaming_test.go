@@ -0,0 +1,103 @@
+// Copyright 2023 the v8go contributors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+package v8go_test
+
+import (
+	"errors"
+	"fmt"
+	"io"
+	"strings"
+	"testing"
+	"testing/iotest"
+
+	v8 "github.com/ionos-cloud/v8go"
+)
+
+func TestCompileUnboundScriptInBackground(t *testing.T) {
+	t.Parallel()
+
+	iso := v8.NewIsolate()
+	defer iso.Dispose()
+	ctx := v8.NewContext(iso)
+	defer ctx.Close()
+
+	var src strings.Builder
+	for i := 0; i < 2000; i++ {
+		fmt.Fprintf(&src, "function f%d(x) { return x + %d }\n", i, i)
+	}
+	src.WriteString("f1999(1)")
+	task := iso.CompileUnboundScriptInBackground(src.String(), "big.js")
+
+	// the isolate stays usable while the script compiles
+	val, err := ctx.RunScript("1 + 1", "other.js")
+	fatalIf(t, err)
+	if val.Int32() != 2 {
+		t.Errorf("expected 2, got %v", val)
+	}
+
+	<-task.Done()
+	us, err := task.Result()
+	fatalIf(t, err)
+	val, err = us.Run(ctx)
+	fatalIf(t, err)
+	if val.Int32() != 2000 {
+		t.Errorf("expected 2000, got %v", val)
+	}
+	if again, _ := task.Result(); again != us {
+		t.Error("expected Result to return the same script")
+	}
+
+	task = iso.CompileUnboundScriptInBackground("let x = ;", "bad.js")
+	_, err = task.Result()
+	if e, ok := err.(*v8.JSError); !ok || !strings.Contains(e.Message, "SyntaxError") || e.Location != "bad.js:1:9" {
+		t.Errorf("expected SyntaxError at bad.js:1:9, got %v", err)
+	}
+}
+
+func TestCompileUnboundScriptFromReader(t *testing.T) {
+	t.Parallel()
+
+	iso := v8.NewIsolate()
+	defer iso.Dispose()
+	ctx := v8.NewContext(iso)
+	defer ctx.Close()
+
+	var src strings.Builder
+	for i := 0; i < 5000; i++ {
+		fmt.Fprintf(&src, "var v%d = %d;\n", i, i)
+	}
+	src.WriteString("function sum() { return v4999 + 1 }; sum()")
+	tests := []struct {
+		r    io.Reader
+		want int32
+	}{
+		{strings.NewReader(src.String()), 5000},
+		{iotest.OneByteReader(strings.NewReader(src.String())), 5000},
+		{strings.NewReader(src.String() + " + 'é€'.length"), 5002},
+	}
+	for _, tt := range tests {
+		us, err := iso.CompileUnboundScriptFromReader(tt.r, "reader.js")
+		fatalIf(t, err)
+		val, err := us.Run(ctx)
+		fatalIf(t, err)
+		if val.Int32() != tt.want {
+			t.Errorf("expected %d, got %v", tt.want, val)
+		}
+	}
+	// the source of the script is kept for Function.prototype.toString
+	if val, _ := ctx.RunScript("sum.toString()", "tostring.js"); val.String() != "function sum() { return v4999 + 1 }" {
+		t.Errorf("unexpected function source %q", val)
+	}
+
+	_, err := iso.CompileUnboundScriptFromReader(strings.NewReader("let x = ;"), "bad.js")
+	if e, ok := err.(*v8.JSError); !ok || !strings.Contains(e.Message, "SyntaxError") {
+		t.Errorf("expected SyntaxError, got %v", err)
+	}
+	readErr := errors.New("read failed")
+	_, err = iso.CompileUnboundScriptFromReader(iotest.ErrReader(readErr), "err.js")
+	if err != readErr {
+		t.Errorf("expected the read error, got %v", err)
+	}
+}
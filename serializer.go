@@ -0,0 +1,111 @@
+// Copyright 2023 the v8go contributors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+package v8go
+
+// #include <stdlib.h>
+// #include "v8go.h"
+import "C"
+
+import (
+	"errors"
+	"runtime"
+	"unsafe"
+)
+
+// Serialize serializes the value with V8's implementation of the HTML structured
+// clone algorithm, which is what postMessage uses to pass values between workers.
+// Unlike JSONStringify, Maps, Sets, Dates, RegExps, typed arrays, BigInts and
+// cycles are preserved. The result can be read back with Deserialize in any
+// isolate of the same V8 version.
+//
+// Values that cannot be cloned, such as functions, return a DataCloneError.
+// Use SerializeWithTransfer for values that contain SharedArrayBuffers.
+func Serialize(val Valuer) ([]byte, error) {
+	if val == nil || val.value() == nil {
+		return nil, errors.New("v8go: Value is required")
+	}
+	rtn := C.SerializeValue(val.value().ptr)
+	if rtn.data == nil {
+		return nil, newJSError(rtn.error)
+	}
+	defer C.free(unsafe.Pointer(rtn.data))
+	return C.GoBytes(unsafe.Pointer(rtn.data), rtn.length), nil
+}
+
+// Deserialize creates a value in the given context from data produced by
+// Serialize.
+func Deserialize(ctx *Context, data []byte) (*Value, error) {
+	if ctx == nil {
+		return nil, errors.New("v8go: Context is required")
+	}
+	if len(data) == 0 {
+		return nil, errors.New("v8go: no data to deserialize")
+	}
+	rtn := C.DeserializeValue(ctx.ptr, (*C.uint8_t)(unsafe.Pointer(&data[0])), C.int(len(data)))
+	return valueResult(ctx, rtn)
+}
+
+// SerializedValue is a value serialized by SerializeWithTransfer. It holds on to
+// the memory of the transferred ArrayBuffers and any SharedArrayBuffers of the
+// value until it is deserialized or released.
+type SerializedValue struct {
+	ptr C.SerializedValuePtr
+}
+
+// SerializeWithTransfer is like Serialize, but the ArrayBuffers in the transfer
+// list are moved rather than copied, like the transfer list of postMessage: the
+// memory backing them is handed to the isolate that deserializes the result and
+// the original buffers are detached. SharedArrayBuffers are always shared with
+// the deserialized value rather than copied.
+//
+// A SerializedValue may be deserialized any number of times, unless it has
+// transferred ArrayBuffers: their memory goes to the first deserialization, and
+// the later ones fail with a DataCloneError.
+func SerializeWithTransfer(val Valuer, transfer ...*Value) (*SerializedValue, error) {
+	if val == nil || val.value() == nil {
+		return nil, errors.New("v8go: Value is required")
+	}
+	var transferPtr *C.ValuePtr
+	if len(transfer) > 0 {
+		ptrs := make([]C.ValuePtr, len(transfer))
+		for i, buf := range transfer {
+			ptrs[i] = buf.ptr
+		}
+		transferPtr = &ptrs[0]
+	}
+
+	rtn := C.SerializeValueTransfer(val.value().ptr, transferPtr, C.int(len(transfer)))
+	if rtn.value == nil {
+		return nil, newJSError(rtn.error)
+	}
+	s := &SerializedValue{ptr: rtn.value}
+	runtime.SetFinalizer(s, (*SerializedValue).Release)
+	return s, nil
+}
+
+// Deserialize creates the serialized value in the given context.
+func (s *SerializedValue) Deserialize(ctx *Context) (*Value, error) {
+	if ctx == nil {
+		return nil, errors.New("v8go: Context is required")
+	}
+	if s.ptr == nil {
+		return nil, errors.New("v8go: SerializedValue has been released")
+	}
+	rtn := C.SerializedValueDeserialize(ctx.ptr, s.ptr)
+	runtime.KeepAlive(s)
+	return valueResult(ctx, rtn)
+}
+
+// Release frees the serialized data and drops the references to the buffers
+// it holds. It is called automatically when the SerializedValue is garbage
+// collected.
+func (s *SerializedValue) Release() {
+	if s.ptr == nil {
+		return
+	}
+	C.SerializedValueFree(s.ptr)
+	s.ptr = nil
+	runtime.SetFinalizer(s, nil)
+}
@@ -0,0 +1,223 @@
+// Copyright 2023 the v8go contributors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+package v8go_test
+
+import (
+	"encoding/json"
+	"fmt"
+	"strings"
+	"testing"
+
+	v8 "github.com/ionos-cloud/v8go"
+)
+
+func TestSerialize(t *testing.T) {
+	t.Parallel()
+
+	ctx1 := v8.NewContext()
+	defer ctx1.Isolate().Dispose()
+	defer ctx1.Close()
+	ctx2 := v8.NewContext()
+	defer ctx2.Isolate().Dispose()
+	defer ctx2.Close()
+
+	if _, err := v8.Serialize(nil); err == nil {
+		t.Error("expected error with <nil> Value")
+	}
+	if _, err := v8.Deserialize(nil, []byte{1}); err == nil {
+		t.Error("expected error with <nil> Context")
+	}
+	if _, err := v8.Deserialize(ctx2, nil); err == nil {
+		t.Error("expected error with no data")
+	}
+	if _, err := v8.Deserialize(ctx2, []byte{0xff, 0x0f, 0xff}); err == nil {
+		t.Error("expected error with malformed data")
+	}
+
+	val, err := ctx1.RunScript(`
+		const o = {
+			map: new Map([[1, 'a']]),
+			set: new Set(['b']),
+			date: new Date(0),
+			big: 2n ** 64n,
+			bytes: new Uint8Array([1, 2, 3]),
+		};
+		o.self = o;
+		o`, "serialize.js")
+	fatalIf(t, err)
+	data, err := v8.Serialize(val)
+	fatalIf(t, err)
+
+	clone, err := v8.Deserialize(ctx2, data)
+	fatalIf(t, err)
+	fatalIf(t, ctx2.Global().Set("o", clone))
+	check, err := ctx2.RunScript(`
+		o.self === o && o.map.get(1) === 'a' && o.set.has('b') &&
+			o.date.getTime() === 0 && o.big === 2n ** 64n && o.bytes.join() === '1,2,3'`, "check.js")
+	fatalIf(t, err)
+	if !check.Boolean() {
+		t.Error("deserialized value does not match the original")
+	}
+
+	fn, _ := ctx1.RunScript("({fn() {}})", "fn.js")
+	if _, err := v8.Serialize(fn); err == nil {
+		t.Error("expected error serializing a function")
+	}
+}
+
+func TestSerializeWithTransfer(t *testing.T) {
+	t.Parallel()
+
+	ctx1 := v8.NewContext()
+	defer ctx1.Isolate().Dispose()
+	defer ctx1.Close()
+	ctx2 := v8.NewContext()
+	defer ctx2.Isolate().Dispose()
+	defer ctx2.Close()
+
+	val, err := ctx1.RunScript(`
+		var buf = new Uint8Array([1, 2, 3]).buffer;
+		var shared = new Int32Array(new SharedArrayBuffer(4));
+		({buf, shared})`, "transfer.js")
+	fatalIf(t, err)
+	buf, _ := ctx1.RunScript("buf", "buf.js")
+	s, err := v8.SerializeWithTransfer(val, buf)
+	fatalIf(t, err)
+	defer s.Release()
+
+	if detached, _ := ctx1.RunScript("buf.byteLength === 0", "detached.js"); !detached.Boolean() {
+		t.Error("expected transferred ArrayBuffer to be detached")
+	}
+
+	clone, err := s.Deserialize(ctx2)
+	fatalIf(t, err)
+	fatalIf(t, ctx2.Global().Set("o", clone))
+	check, err := ctx2.RunScript("o.shared[0] = 42; new Uint8Array(o.buf).join() === '1,2,3'", "check.js")
+	fatalIf(t, err)
+	if !check.Boolean() {
+		t.Error("transferred ArrayBuffer does not match the original")
+	}
+	if shared, _ := ctx1.RunScript("shared[0]", "shared.js"); shared.Int32() != 42 {
+		t.Errorf("expected SharedArrayBuffer memory to be shared, got %d", shared.Int32())
+	}
+
+	if _, err := s.Deserialize(ctx2); err == nil {
+		t.Error("expected error deserializing transferred buffers twice")
+	}
+	if _, err := v8.SerializeWithTransfer(val, buf); err == nil {
+		t.Error("expected error transferring a detached ArrayBuffer")
+	}
+	notBuf, _ := ctx1.RunScript("({})", "obj.js")
+	if _, err := v8.SerializeWithTransfer(val, notBuf); err == nil {
+		t.Error("expected error transferring a value that is not an ArrayBuffer")
+	}
+	if _, err := v8.Serialize(val); err == nil {
+		t.Error("expected error serializing a SharedArrayBuffer without transfer")
+	}
+
+	s.Release()
+	if _, err := s.Deserialize(ctx2); err == nil {
+		t.Error("expected error using a released SerializedValue")
+	}
+}
+
+func TestSerializedValueDeserializeTwice(t *testing.T) {
+	t.Parallel()
+
+	ctx1 := v8.NewContext()
+	defer ctx1.Isolate().Dispose()
+	defer ctx1.Close()
+	ctx2 := v8.NewContext()
+	defer ctx2.Isolate().Dispose()
+	defer ctx2.Close()
+
+	val, err := ctx1.RunScript("globalThis.shared = new Int32Array(new SharedArrayBuffer(4)); ({shared: shared.buffer, n: 1})", "val.js")
+	fatalIf(t, err)
+	s, err := v8.SerializeWithTransfer(val)
+	fatalIf(t, err)
+	defer s.Release()
+	for i := 0; i < 2; i++ {
+		clone, err := s.Deserialize(ctx2)
+		fatalIf(t, err)
+		fatalIf(t, ctx2.Global().Set(fmt.Sprintf("o%d", i), clone))
+	}
+	check, err := ctx2.RunScript("new Int32Array(o0.shared)[0] = 7; new Int32Array(o1.shared)[0] === 7 && o1.n === 1", "check.js")
+	fatalIf(t, err)
+	if !check.Boolean() {
+		t.Error("expected both deserializations to share the SharedArrayBuffer")
+	}
+
+	buf, _ := ctx1.RunScript("new ArrayBuffer(8)", "buf.js")
+	s, err = v8.SerializeWithTransfer(buf, buf)
+	fatalIf(t, err)
+	defer s.Release()
+	_, err = s.Deserialize(ctx2)
+	fatalIf(t, err)
+	if _, err := s.Deserialize(ctx2); err == nil || !strings.Contains(err.Error(), "DataCloneError") {
+		t.Errorf("expected a DataCloneError deserializing transferred buffers twice, got %v", err)
+	}
+}
+
+func ExampleSerialize() {
+	ctx1 := v8.NewContext()
+	defer ctx1.Isolate().Dispose()
+	defer ctx1.Close()
+	ctx2 := v8.NewContext()
+	defer ctx2.Isolate().Dispose()
+	defer ctx2.Close()
+
+	val, _ := ctx1.RunScript("new Map([['answer', 42]])", "map.js")
+	data, _ := v8.Serialize(val)
+	clone, _ := v8.Deserialize(ctx2, data)
+	key, _ := v8.NewValue(ctx2.Isolate(), "answer")
+	obj, _ := clone.AsObject()
+	answer, _ := obj.MethodCall("get", key)
+	fmt.Println(answer)
+	// Output:
+	// 42
+}
+
+func BenchmarkSerialize(b *testing.B) {
+	ctx1 := v8.NewContext()
+	defer ctx1.Isolate().Dispose()
+	defer ctx1.Close()
+	ctx2 := v8.NewContext()
+	defer ctx2.Isolate().Dispose()
+	defer ctx2.Close()
+	payload, _ := json.Marshal(makePayload(100))
+	val, err := v8.JSONParse(ctx1, string(payload))
+	if err != nil {
+		b.Fatal(err)
+	}
+
+	b.Run("Serialize", func(b *testing.B) {
+		b.ReportAllocs()
+		for n := 0; n < b.N; n++ {
+			data, err := v8.Serialize(val)
+			if err != nil {
+				b.Fatal(err)
+			}
+			clone, err := v8.Deserialize(ctx2, data)
+			if err != nil {
+				b.Fatal(err)
+			}
+			clone.Release()
+		}
+	})
+	b.Run("JSON", func(b *testing.B) {
+		b.ReportAllocs()
+		for n := 0; n < b.N; n++ {
+			str, err := v8.JSONStringify(ctx1, val)
+			if err != nil {
+				b.Fatal(err)
+			}
+			clone, err := v8.JSONParse(ctx2, str)
+			if err != nil {
+				b.Fatal(err)
+			}
+			clone.Release()
+		}
+	})
+}
@@ -0,0 +1,89 @@
+// Copyright 2023 the v8go contributors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+package v8go
+
+// #include "v8go.h"
+import "C"
+
+import (
+	"errors"
+	"runtime"
+)
+
+// SharedMemory is memory that backs SharedArrayBuffers, which may be installed
+// in any number of isolates at once. JavaScript in each of them and Go all see
+// the same bytes, so workers can exchange data without serializing it. Use
+// Atomics in JavaScript, and sync/atomic in Go, to synchronize access.
+//
+// V8 is built with its sandbox enabled, which requires the memory to be
+// allocated by V8 rather than by Go or mmap. It is not counted against the
+// ArrayBufferAllocator limit of any isolate.
+type SharedMemory struct {
+	store backingStore
+}
+
+// NewSharedMemory allocates zero-filled shared memory of the given size.
+func NewSharedMemory(byteLength int) (*SharedMemory, error) {
+	if byteLength <= 0 {
+		return nil, errors.New("v8go: SharedMemory size must be positive")
+	}
+	initializeIfNecessary()
+	rtn := C.NewSharedMemory(C.size_t(byteLength))
+	if rtn.ptr == nil {
+		return nil, errors.New("v8go: failed to allocate SharedMemory")
+	}
+	return newSharedMemory(rtn), nil
+}
+
+func newSharedMemory(rtn C.RtnBackingStore) *SharedMemory {
+	m := &SharedMemory{}
+	m.store.set(rtn)
+	runtime.SetFinalizer(m, func(m *SharedMemory) { m.store.release() })
+	return m
+}
+
+// AsSharedMemory returns the memory of a SharedArrayBuffer, or an error if the
+// value is not one. This lets memory allocated by JavaScript be shared with Go
+// and installed in other isolates.
+func (v *Value) AsSharedMemory() (*SharedMemory, error) {
+	if !v.IsSharedArrayBuffer() {
+		return nil, errors.New("v8go: value is not a SharedArrayBuffer")
+	}
+	return newSharedMemory(C.ValueGetBackingStore(v.ptr)), nil
+}
+
+// NewSharedArrayBuffer creates a SharedArrayBuffer in the given context over
+// the shared memory.
+func NewSharedArrayBuffer(ctx *Context, mem *SharedMemory) (*Value, error) {
+	if ctx == nil {
+		return nil, errors.New("v8go: Context is required")
+	}
+	if mem == nil || mem.store.ptr == nil {
+		return nil, errors.New("v8go: SharedMemory is required")
+	}
+	rtn := C.NewSharedArrayBuffer(ctx.ptr, mem.store.ptr)
+	runtime.KeepAlive(mem)
+	return valueResult(ctx, rtn)
+}
+
+// ByteLength returns the size of the memory in bytes.
+func (m *SharedMemory) ByteLength() int {
+	return len(m.store.data)
+}
+
+// Bytes returns the shared memory. It stays valid until Release is called or
+// the SharedMemory is garbage collected, so keep the SharedMemory reachable
+// while the slice is in use.
+func (m *SharedMemory) Bytes() []byte {
+	return m.store.data
+}
+
+// Release drops the Go reference to the memory. The memory itself is freed
+// once no SharedArrayBuffer uses it either. Using the Bytes afterwards will
+// result in undefined behavior.
+func (m *SharedMemory) Release() {
+	m.store.release()
+	runtime.SetFinalizer(m, nil)
+}
@@ -0,0 +1,102 @@
+// Copyright 2023 the v8go contributors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+package v8go_test
+
+import (
+	"sync"
+	"sync/atomic"
+	"testing"
+	"unsafe"
+
+	v8 "github.com/ionos-cloud/v8go"
+)
+
+func TestSharedMemory(t *testing.T) {
+	t.Parallel()
+
+	if _, err := v8.NewSharedMemory(0); err == nil {
+		t.Error("expected error with zero size")
+	}
+	mem, err := v8.NewSharedMemory(8)
+	fatalIf(t, err)
+	defer mem.Release()
+	if mem.ByteLength() != 8 || len(mem.Bytes()) != 8 {
+		t.Fatalf("expected 8 bytes, got %d", mem.ByteLength())
+	}
+	counter := (*int32)(unsafe.Pointer(&mem.Bytes()[0]))
+
+	// every isolate increments the same counter concurrently
+	const isolates = 4
+	var wg sync.WaitGroup
+	for i := 0; i < isolates; i++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			ctx := v8.NewContext()
+			defer ctx.Isolate().Dispose()
+			defer ctx.Close()
+
+			sab, err := v8.NewSharedArrayBuffer(ctx, mem)
+			if err != nil {
+				t.Error(err)
+				return
+			}
+			ctx.Global().Set("sab", sab)
+			if _, err := ctx.RunScript("const c = new Int32Array(sab); for (let i = 0; i < 1000; i++) Atomics.add(c, 0, 1)", "add.js"); err != nil {
+				t.Error(err)
+			}
+		}()
+	}
+	for i := 0; i < 1000; i++ {
+		atomic.AddInt32(counter, 1)
+	}
+	wg.Wait()
+	if n := atomic.LoadInt32(counter); n != (isolates+1)*1000 {
+		t.Errorf("expected counter %d, got %d", (isolates+1)*1000, n)
+	}
+
+	if _, err := v8.NewSharedArrayBuffer(nil, mem); err == nil {
+		t.Error("expected error with <nil> Context")
+	}
+}
+
+func TestValueAsSharedMemory(t *testing.T) {
+	t.Parallel()
+
+	ctx1 := v8.NewContext()
+	defer ctx1.Isolate().Dispose()
+	defer ctx1.Close()
+	ctx2 := v8.NewContext()
+	defer ctx2.Isolate().Dispose()
+	defer ctx2.Close()
+
+	val, err := ctx1.RunScript("var u8 = new Uint8Array(new SharedArrayBuffer(4)); u8[0] = 7; u8.buffer", "sab.js")
+	fatalIf(t, err)
+	mem, err := val.AsSharedMemory()
+	fatalIf(t, err)
+	defer mem.Release()
+	if data := mem.Bytes(); len(data) != 4 || data[0] != 7 {
+		t.Errorf("unexpected bytes %v", data)
+	}
+
+	sab, err := v8.NewSharedArrayBuffer(ctx2, mem)
+	fatalIf(t, err)
+	if !sab.IsSharedArrayBuffer() {
+		t.Error("expected a SharedArrayBuffer")
+	}
+	fatalIf(t, ctx2.Global().Set("sab", sab))
+	ctx2.RunScript("new Uint8Array(sab)[1] = 8", "write.js")
+	if v, _ := ctx1.RunScript("u8[1]", "read.js"); v.Int32() != 8 {
+		t.Errorf("expected write from the other isolate to be visible, got %d", v.Int32())
+	}
+
+	if _, err := ctx1.Global().AsSharedMemory(); err == nil {
+		t.Error("expected error for a value that is not a SharedArrayBuffer")
+	}
+	mem.Release()
+	if _, err := v8.NewSharedArrayBuffer(ctx2, mem); err == nil {
+		t.Error("expected error with released SharedMemory")
+	}
+}
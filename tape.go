@@ -0,0 +1,865 @@
+// Copyright 2023 the v8go contributors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+package v8go
+
+// #include "v8go.h"
+import "C"
+
+import (
+	"encoding/binary"
+	"errors"
+	"fmt"
+	"math"
+	"math/big"
+	"reflect"
+	"sort"
+	"strconv"
+	"strings"
+	"sync"
+	"unicode/utf8"
+	"unsafe"
+)
+
+// The tape is a flat binary encoding of a value graph. It is written on one
+// side of the cgo boundary and read on the other so that a whole value crosses
+// in a single call. Each value starts with a one byte tag:
+//
+//	TapeUndefined, TapeNull, TapeFalse, TapeTrue   no payload
+//	TapeInt32          zig-zag varint
+//	TapeFloat64        8 bytes, little endian IEEE 754
+//	TapeString         uvarint byte length, UTF-8 bytes
+//	TapeOneByteString  uvarint length, Latin-1 bytes
+//	TapeBigInt         sign byte, uvarint word count, 8 byte little endian words
+//	TapeArray          uvarint length, elements
+//	TapeObject         uvarint length, (key, value) pairs
+//	TapeCyclicArray    as TapeArray, for an array a TapeCycle refers to
+//	TapeCyclicObject   as TapeObject, for an object a TapeCycle refers to
+//	TapeCycle          uvarint n, the nth enclosing array or object, 0 being
+//	                   the innermost one
+//	TapeBuffer         TapeBufferKind byte, uvarint byte length, the contents
+//	                   in native (little endian) byte order
+//	TapeValueRef       native pointer to an existing value (Go to JS only)
+//
+// A key is a TapeString or TapeOneByteString, or a TapeKeyRef followed by the
+// uvarint index of a key given literally earlier in the same tape.
+//
+// Writers mark a container as cyclic by patching its tag once one of its
+// descendants refers back to it, so that readers can build every other
+// container in bulk from its finished elements. Shared values that do not form
+// a cycle are written once per occurrence.
+const (
+	tapeUndefined = C.TapeUndefined
+	tapeNull      = C.TapeNull
+	tapeFalse     = C.TapeFalse
+	tapeTrue      = C.TapeTrue
+	tapeInt32     = C.TapeInt32
+	tapeFloat64   = C.TapeFloat64
+	tapeString    = C.TapeString
+	tapeBigInt    = C.TapeBigInt
+	tapeArray     = C.TapeArray
+	tapeObject    = C.TapeObject
+	tapeValueRef  = C.TapeValueRef
+
+	tapeOneByteString = C.TapeOneByteString
+	tapeKeyRef        = C.TapeKeyRef
+	tapeCycle         = C.TapeCycle
+	tapeCyclicArray   = C.TapeCyclicArray
+	tapeCyclicObject  = C.TapeCyclicObject
+	tapeBuffer        = C.TapeBuffer
+)
+
+const (
+	tapeArrayBufferKind       = C.TapeArrayBufferKind
+	tapeUint8ArrayKind        = C.TapeUint8ArrayKind
+	tapeUint8ClampedArrayKind = C.TapeUint8ClampedArrayKind
+	tapeInt8ArrayKind         = C.TapeInt8ArrayKind
+	tapeUint16ArrayKind       = C.TapeUint16ArrayKind
+	tapeInt16ArrayKind        = C.TapeInt16ArrayKind
+	tapeUint32ArrayKind       = C.TapeUint32ArrayKind
+	tapeInt32ArrayKind        = C.TapeInt32ArrayKind
+	tapeFloat32ArrayKind      = C.TapeFloat32ArrayKind
+	tapeFloat64ArrayKind      = C.TapeFloat64ArrayKind
+	tapeBigInt64ArrayKind     = C.TapeBigInt64ArrayKind
+	tapeBigUint64ArrayKind    = C.TapeBigUint64ArrayKind
+)
+
+// tapeMaxDepth matches kTapeMaxDepth in v8go.cc.
+const tapeMaxDepth = 1000
+
+var errTapeTruncated = errors.New("v8go: tape: unexpected end of data")
+
+type tapeEncoder struct {
+	buf   []byte
+	path  []tapeAncestor
+	ident tapeIdent
+}
+
+// tapeIdent identifies the map, slice or pointed-to value a container was
+// written from, so that cycles can be detected.
+type tapeIdent struct {
+	ptr unsafe.Pointer
+	len int
+	typ reflect.Type
+}
+
+type tapeAncestor struct {
+	ident  tapeIdent
+	offset int
+}
+
+var tapeEncoderPool = sync.Pool{
+	New: func() interface{} { return &tapeEncoder{buf: make([]byte, 0, 512)} },
+}
+
+func (e *tapeEncoder) reset() {
+	e.buf = e.buf[:0]
+	e.path = e.path[:0]
+	e.ident = tapeIdent{}
+}
+
+// enter starts a container. Containers copied by value, such as structs and
+// arrays, have a zero id.
+func (e *tapeEncoder) enter(tag byte, id tapeIdent, n int) {
+	e.path = append(e.path, tapeAncestor{ident: id, offset: len(e.buf)})
+	e.buf = append(e.buf, tag)
+	e.uvarint(uint64(n))
+}
+
+func (e *tapeEncoder) leave() {
+	e.path = e.path[:len(e.path)-1]
+}
+
+// cycle writes a reference to the container identified by id if it is one of
+// the containers being written, and marks that container as cyclic.
+func (e *tapeEncoder) cycle(id tapeIdent) bool {
+	for i := len(e.path) - 1; i >= 0; i-- {
+		if e.path[i].ident != id {
+			continue
+		}
+		off := e.path[i].offset
+		if e.buf[off] == tapeArray {
+			e.buf[off] = tapeCyclicArray
+		} else {
+			e.buf[off] = tapeCyclicObject
+		}
+		e.byte(tapeCycle)
+		e.uvarint(uint64(len(e.path) - 1 - i))
+		return true
+	}
+	return false
+}
+
+func (e *tapeEncoder) byte(b byte) {
+	e.buf = append(e.buf, b)
+}
+
+func (e *tapeEncoder) uvarint(v uint64) {
+	e.buf = binary.AppendUvarint(e.buf, v)
+}
+
+func (e *tapeEncoder) int32(i int32) {
+	e.buf = append(e.buf, tapeInt32)
+	e.buf = binary.AppendVarint(e.buf, int64(i))
+}
+
+func (e *tapeEncoder) float64(f float64) {
+	e.buf = append(e.buf, tapeFloat64)
+	e.buf = binary.LittleEndian.AppendUint64(e.buf, math.Float64bits(f))
+}
+
+func (e *tapeEncoder) int64(i int64) {
+	if i >= math.MinInt32 && i <= math.MaxInt32 {
+		e.int32(int32(i))
+		return
+	}
+	e.float64(float64(i))
+}
+
+func (e *tapeEncoder) uint64(u uint64) {
+	if u <= math.MaxInt32 {
+		e.int32(int32(u))
+		return
+	}
+	e.float64(float64(u))
+}
+
+func (e *tapeEncoder) string(s string) {
+	e.uvarint(uint64(len(s)))
+	e.buf = append(e.buf, s...)
+}
+
+func (e *tapeEncoder) key(k string) {
+	e.buf = append(e.buf, tapeString)
+	e.string(k)
+}
+
+func (e *tapeEncoder) buffer(kind byte, b []byte) {
+	e.buf = append(e.buf, tapeBuffer, kind)
+	e.uvarint(uint64(len(b)))
+	e.buf = append(e.buf, b...)
+}
+
+func (e *tapeEncoder) bigInt(b *big.Int) {
+	e.buf = append(e.buf, tapeBigInt)
+	if b.Sign() < 0 {
+		e.byte(1)
+	} else {
+		e.byte(0)
+	}
+	bits := b.Bits()
+	e.uvarint(uint64(len(bits)))
+	for _, w := range bits {
+		e.buf = binary.LittleEndian.AppendUint64(e.buf, uint64(w))
+	}
+}
+
+func (e *tapeEncoder) encode(val interface{}, depth int) error {
+	if depth > tapeMaxDepth {
+		return errors.New("v8go: value nested too deeply")
+	}
+
+	// Fast paths for the types produced by encoding/json and the common
+	// primitives, avoiding reflection.
+	switch v := val.(type) {
+	case nil:
+		e.byte(tapeNull)
+	case bool:
+		if v {
+			e.byte(tapeTrue)
+		} else {
+			e.byte(tapeFalse)
+		}
+	case string:
+		e.byte(tapeString)
+		e.string(v)
+	case int:
+		e.int64(int64(v))
+	case int32:
+		e.int32(v)
+	case int64:
+		e.int64(v)
+	case uint32:
+		e.uint64(uint64(v))
+	case uint64:
+		e.uint64(v)
+	case float64:
+		e.float64(v)
+	case *big.Int:
+		if v == nil {
+			e.byte(tapeNull)
+			break
+		}
+		e.bigInt(v)
+	case Valuer:
+		if rv := reflect.ValueOf(v); rv.Kind() == reflect.Pointer && rv.IsNil() {
+			e.byte(tapeNull)
+			break
+		}
+		ptr := v.value().ptr
+		e.byte(tapeValueRef)
+		e.buf = append(e.buf, (*[unsafe.Sizeof(ptr)]byte)(unsafe.Pointer(&ptr))[:]...)
+	case []byte:
+		if v == nil {
+			e.byte(tapeNull)
+			break
+		}
+		e.buffer(tapeUint8ArrayKind, v)
+	case []interface{}:
+		if v == nil {
+			e.byte(tapeNull)
+			break
+		}
+		id := tapeIdent{unsafe.Pointer(unsafe.SliceData(v)), len(v), interfaceSliceType}
+		if e.cycle(id) {
+			break
+		}
+		e.enter(tapeArray, id, len(v))
+		for _, elem := range v {
+			if err := e.encode(elem, depth+1); err != nil {
+				return err
+			}
+		}
+		e.leave()
+	case map[string]interface{}:
+		if v == nil {
+			e.byte(tapeNull)
+			break
+		}
+		id := tapeIdent{reflect.ValueOf(v).UnsafePointer(), 0, interfaceMapType}
+		if e.cycle(id) {
+			break
+		}
+		// like encoding/json, keys are sorted so that the order of the
+		// properties does not depend on the iteration order of the map
+		keys := make([]string, 0, len(v))
+		for k := range v {
+			keys = append(keys, k)
+		}
+		sort.Strings(keys)
+		e.enter(tapeObject, id, len(v))
+		for _, k := range keys {
+			e.key(k)
+			if err := e.encode(v[k], depth+1); err != nil {
+				return err
+			}
+		}
+		e.leave()
+	default:
+		return e.encodeReflect(reflect.ValueOf(val), depth)
+	}
+	return nil
+}
+
+var (
+	valuerType         = reflect.TypeOf((*Valuer)(nil)).Elem()
+	bigIntType         = reflect.TypeOf((*big.Int)(nil))
+	interfaceSliceType = reflect.TypeOf([]interface{}(nil))
+	interfaceMapType   = reflect.TypeOf(map[string]interface{}(nil))
+)
+
+// tapeBufferKind returns the typed array that slices of k are written as.
+// 64 bit integers are left as arrays of Numbers, like other integers, rather
+// than becoming BigInt64Arrays.
+func tapeBufferKind(k reflect.Kind) (byte, bool) {
+	switch k {
+	case reflect.Uint8:
+		return tapeUint8ArrayKind, true
+	case reflect.Int8:
+		return tapeInt8ArrayKind, true
+	case reflect.Uint16:
+		return tapeUint16ArrayKind, true
+	case reflect.Int16:
+		return tapeInt16ArrayKind, true
+	case reflect.Uint32:
+		return tapeUint32ArrayKind, true
+	case reflect.Int32:
+		return tapeInt32ArrayKind, true
+	case reflect.Float32:
+		return tapeFloat32ArrayKind, true
+	case reflect.Float64:
+		return tapeFloat64ArrayKind, true
+	}
+	return 0, false
+}
+
+func (e *tapeEncoder) encodeReflect(rv reflect.Value, depth int) error {
+	if depth > tapeMaxDepth {
+		return errors.New("v8go: value nested too deeply")
+	}
+
+	switch rv.Kind() {
+	case reflect.Bool:
+		if rv.Bool() {
+			e.byte(tapeTrue)
+		} else {
+			e.byte(tapeFalse)
+		}
+	case reflect.Int, reflect.Int8, reflect.Int16, reflect.Int32, reflect.Int64:
+		e.int64(rv.Int())
+	case reflect.Uint, reflect.Uint8, reflect.Uint16, reflect.Uint32, reflect.Uint64, reflect.Uintptr:
+		e.uint64(rv.Uint())
+	case reflect.Float32, reflect.Float64:
+		e.float64(rv.Float())
+	case reflect.String:
+		e.byte(tapeString)
+		e.string(rv.String())
+	case reflect.Interface:
+		if rv.IsNil() {
+			e.byte(tapeNull)
+			return nil
+		}
+		return e.encode(rv.Elem().Interface(), depth+1)
+	case reflect.Pointer:
+		if rv.IsNil() {
+			e.byte(tapeNull)
+			return nil
+		}
+		if rv.Type() == bigIntType || rv.Type().Implements(valuerType) {
+			return e.encode(rv.Interface(), depth)
+		}
+		elem := rv.Elem()
+		if k := elem.Kind(); k == reflect.Struct || k == reflect.Array {
+			id := tapeIdent{rv.UnsafePointer(), 0, rv.Type()}
+			if e.cycle(id) {
+				return nil
+			}
+			e.ident = id
+		}
+		return e.encodeReflect(elem, depth+1)
+	case reflect.Slice:
+		if rv.IsNil() {
+			e.byte(tapeNull)
+			return nil
+		}
+		et := rv.Type().Elem()
+		if kind, ok := tapeBufferKind(et.Kind()); ok {
+			e.buffer(kind, unsafe.Slice((*byte)(rv.UnsafePointer()), rv.Len()*int(et.Size())))
+			return nil
+		}
+		id := tapeIdent{rv.UnsafePointer(), rv.Len(), rv.Type()}
+		if e.cycle(id) {
+			return nil
+		}
+		e.ident = id
+		fallthrough
+	case reflect.Array:
+		id := e.ident
+		e.ident = tapeIdent{}
+		n := rv.Len()
+		e.enter(tapeArray, id, n)
+		for i := 0; i < n; i++ {
+			if err := e.encodeReflect(rv.Index(i), depth+1); err != nil {
+				return err
+			}
+		}
+		e.leave()
+	case reflect.Map:
+		if rv.IsNil() {
+			e.byte(tapeNull)
+			return nil
+		}
+		id := tapeIdent{rv.UnsafePointer(), 0, rv.Type()}
+		if e.cycle(id) {
+			return nil
+		}
+		entries := make([]tapeMapEntry, 0, rv.Len())
+		iter := rv.MapRange()
+		for iter.Next() {
+			key, err := tapeMapKey(iter.Key())
+			if err != nil {
+				return err
+			}
+			entries = append(entries, tapeMapEntry{key, iter.Value()})
+		}
+		sort.Slice(entries, func(i, j int) bool { return entries[i].key < entries[j].key })
+		e.enter(tapeObject, id, len(entries))
+		for _, entry := range entries {
+			e.key(entry.key)
+			if err := e.encodeReflect(entry.val, depth+1); err != nil {
+				return err
+			}
+		}
+		e.leave()
+	case reflect.Struct:
+		id := e.ident
+		e.ident = tapeIdent{}
+		fields := tapeStructFields(rv.Type())
+		count := 0
+		for i := range fields {
+			if !fields[i].skip(rv) {
+				count++
+			}
+		}
+		e.enter(tapeObject, id, count)
+		for i := range fields {
+			f := &fields[i]
+			if f.skip(rv) {
+				continue
+			}
+			e.key(f.name)
+			if err := e.encodeReflect(rv.FieldByIndex(f.index), depth+1); err != nil {
+				return err
+			}
+		}
+		e.leave()
+	default:
+		return fmt.Errorf("v8go: unsupported value type `%s`", rv.Type())
+	}
+	return nil
+}
+
+// tapeMapEntry is a map entry with its key formatted as a string, which orders
+// the entries as encoding/json does.
+type tapeMapEntry struct {
+	key string
+	val reflect.Value
+}
+
+func tapeMapKey(k reflect.Value) (string, error) {
+	switch k.Kind() {
+	case reflect.String:
+		return k.String(), nil
+	case reflect.Int, reflect.Int8, reflect.Int16, reflect.Int32, reflect.Int64:
+		return strconv.FormatInt(k.Int(), 10), nil
+	case reflect.Uint, reflect.Uint8, reflect.Uint16, reflect.Uint32, reflect.Uint64, reflect.Uintptr:
+		return strconv.FormatUint(k.Uint(), 10), nil
+	}
+	return "", fmt.Errorf("v8go: unsupported map key type `%s`", k.Type())
+}
+
+// tapeField is an exported struct field, named according to its `json` tag
+// so that structs marshal the same way as with encoding/json.
+type tapeField struct {
+	name      string
+	index     []int
+	omitEmpty bool
+}
+
+func (f *tapeField) skip(rv reflect.Value) bool {
+	if len(f.index) > 1 {
+		// promoted through an embedded pointer, which may be nil
+		for _, i := range f.index[:len(f.index)-1] {
+			rv = rv.Field(i)
+			if rv.Kind() == reflect.Pointer {
+				if rv.IsNil() {
+					return true
+				}
+				rv = rv.Elem()
+			}
+		}
+		rv = rv.Field(f.index[len(f.index)-1])
+	} else {
+		rv = rv.Field(f.index[0])
+	}
+	return f.omitEmpty && tapeIsEmpty(rv)
+}
+
+// tapeIsEmpty reports whether omitempty leaves out a field of this value,
+// with the rules of encoding/json: structs are never empty, while empty
+// slices and maps are even when they are not nil.
+func tapeIsEmpty(rv reflect.Value) bool {
+	switch rv.Kind() {
+	case reflect.Array, reflect.Map, reflect.Slice, reflect.String:
+		return rv.Len() == 0
+	case reflect.Bool:
+		return !rv.Bool()
+	case reflect.Int, reflect.Int8, reflect.Int16, reflect.Int32, reflect.Int64:
+		return rv.Int() == 0
+	case reflect.Uint, reflect.Uint8, reflect.Uint16, reflect.Uint32, reflect.Uint64, reflect.Uintptr:
+		return rv.Uint() == 0
+	case reflect.Float32, reflect.Float64:
+		return rv.Float() == 0
+	case reflect.Interface, reflect.Pointer:
+		return rv.IsNil()
+	}
+	return false
+}
+
+var tapeFieldCache sync.Map // map[reflect.Type][]tapeField
+
+func tapeStructFields(t reflect.Type) []tapeField {
+	if fields, ok := tapeFieldCache.Load(t); ok {
+		return fields.([]tapeField)
+	}
+	var fields []tapeField
+	collectTapeFields(t, nil, &fields)
+	sort.SliceStable(fields, func(i, j int) bool { return len(fields[i].index) < len(fields[j].index) })
+	// outer fields shadow promoted fields of the same name
+	seen := map[string]bool{}
+	unique := fields[:0]
+	for _, f := range fields {
+		if !seen[f.name] {
+			seen[f.name] = true
+			unique = append(unique, f)
+		}
+	}
+	// restore declaration order, as encoding/json does
+	sort.Slice(unique, func(i, j int) bool {
+		a, b := unique[i].index, unique[j].index
+		for k := 0; k < len(a) && k < len(b); k++ {
+			if a[k] != b[k] {
+				return a[k] < b[k]
+			}
+		}
+		return len(a) < len(b)
+	})
+	tapeFieldCache.Store(t, unique)
+	return unique
+}
+
+func collectTapeFields(t reflect.Type, index []int, fields *[]tapeField) {
+	for i := 0; i < t.NumField(); i++ {
+		sf := t.Field(i)
+		tag := sf.Tag.Get("json")
+		if tag == "-" {
+			continue
+		}
+		name, opts, _ := strings.Cut(tag, ",")
+		idx := append(append([]int(nil), index...), i)
+
+		if sf.Anonymous && name == "" {
+			ft := sf.Type
+			if ft.Kind() == reflect.Pointer {
+				ft = ft.Elem()
+			}
+			if ft.Kind() == reflect.Struct {
+				collectTapeFields(ft, idx, fields)
+				continue
+			}
+		}
+		if !sf.IsExported() {
+			continue
+		}
+		if name == "" {
+			name = sf.Name
+		}
+		*fields = append(*fields, tapeField{
+			name:      name,
+			index:     idx,
+			omitEmpty: strings.Contains(opts, "omitempty"),
+		})
+	}
+}
+
+type tapeDecoder struct {
+	data []byte
+	pos  int
+	keys []string
+	// the enclosing containers, nil unless a TapeCycle may refer to them
+	path []interface{}
+}
+
+func (d *tapeDecoder) byte() (byte, error) {
+	if d.pos >= len(d.data) {
+		return 0, errTapeTruncated
+	}
+	b := d.data[d.pos]
+	d.pos++
+	return b, nil
+}
+
+func (d *tapeDecoder) uvarint() (uint64, error) {
+	v, n := binary.Uvarint(d.data[d.pos:])
+	if n <= 0 {
+		return 0, errTapeTruncated
+	}
+	d.pos += n
+	return v, nil
+}
+
+func (d *tapeDecoder) count() (int, error) {
+	v, err := d.uvarint()
+	if err != nil {
+		return 0, err
+	}
+	if v > uint64(len(d.data)-d.pos) {
+		return 0, errTapeTruncated
+	}
+	return int(v), nil
+}
+
+func (d *tapeDecoder) raw(n int) ([]byte, error) {
+	if n > len(d.data)-d.pos {
+		return nil, errTapeTruncated
+	}
+	b := d.data[d.pos : d.pos+n]
+	d.pos += n
+	return b, nil
+}
+
+func (d *tapeDecoder) string(tag byte) (string, error) {
+	n, err := d.count()
+	if err != nil {
+		return "", err
+	}
+	b, err := d.raw(n)
+	if err != nil || tag == tapeString {
+		return string(b), err
+	}
+	return latin1String(b), nil
+}
+
+func (d *tapeDecoder) key() (string, error) {
+	tag, err := d.byte()
+	if err != nil {
+		return "", err
+	}
+	switch tag {
+	case tapeKeyRef:
+		i, err := d.uvarint()
+		if err != nil {
+			return "", err
+		}
+		if i >= uint64(len(d.keys)) {
+			return "", errors.New("v8go: tape: invalid key reference")
+		}
+		return d.keys[i], nil
+	case tapeString, tapeOneByteString:
+		k, err := d.string(tag)
+		if err != nil {
+			return "", err
+		}
+		d.keys = append(d.keys, k)
+		return k, nil
+	}
+	return "", fmt.Errorf("v8go: tape: invalid key tag %d", tag)
+}
+
+func latin1String(b []byte) string {
+	n := 0
+	for _, c := range b {
+		if c >= utf8.RuneSelf {
+			n++
+		}
+	}
+	if n == 0 {
+		return string(b)
+	}
+	buf := make([]byte, 0, len(b)+n)
+	for _, c := range b {
+		buf = utf8.AppendRune(buf, rune(c))
+	}
+	return string(buf)
+}
+
+func (d *tapeDecoder) buffer() (interface{}, error) {
+	kind, err := d.byte()
+	if err != nil {
+		return nil, err
+	}
+	n, err := d.count()
+	if err != nil {
+		return nil, err
+	}
+	b, err := d.raw(n)
+	if err != nil {
+		return nil, err
+	}
+	switch kind {
+	case tapeArrayBufferKind, tapeUint8ArrayKind, tapeUint8ClampedArrayKind:
+		return tapeBufferCopy[byte](b)
+	case tapeInt8ArrayKind:
+		return tapeBufferCopy[int8](b)
+	case tapeUint16ArrayKind:
+		return tapeBufferCopy[uint16](b)
+	case tapeInt16ArrayKind:
+		return tapeBufferCopy[int16](b)
+	case tapeUint32ArrayKind:
+		return tapeBufferCopy[uint32](b)
+	case tapeInt32ArrayKind:
+		return tapeBufferCopy[int32](b)
+	case tapeFloat32ArrayKind:
+		return tapeBufferCopy[float32](b)
+	case tapeFloat64ArrayKind:
+		return tapeBufferCopy[float64](b)
+	case tapeBigInt64ArrayKind:
+		return tapeBufferCopy[int64](b)
+	case tapeBigUint64ArrayKind:
+		return tapeBufferCopy[uint64](b)
+	}
+	return nil, fmt.Errorf("v8go: tape: unknown buffer kind %d", kind)
+}
+
+// tapeBufferCopy copies the contents of a typed array into a new slice of its
+// element type.
+func tapeBufferCopy[T any](b []byte) (interface{}, error) {
+	var zero T
+	size := int(unsafe.Sizeof(zero))
+	if len(b)%size != 0 {
+		return nil, errors.New("v8go: tape: buffer length is not a multiple of its element size")
+	}
+	s := make([]T, len(b)/size)
+	if len(s) > 0 {
+		copy(unsafe.Slice((*byte)(unsafe.Pointer(&s[0])), len(b)), b)
+	}
+	return s, nil
+}
+
+func (d *tapeDecoder) decode(depth int) (interface{}, error) {
+	if depth > tapeMaxDepth {
+		return nil, errors.New("v8go: tape: value nested too deeply")
+	}
+	tag, err := d.byte()
+	if err != nil {
+		return nil, err
+	}
+	switch tag {
+	case tapeUndefined, tapeNull:
+		return nil, nil
+	case tapeFalse:
+		return false, nil
+	case tapeTrue:
+		return true, nil
+	case tapeInt32:
+		v, n := binary.Varint(d.data[d.pos:])
+		if n <= 0 {
+			return nil, errTapeTruncated
+		}
+		d.pos += n
+		return float64(v), nil
+	case tapeFloat64:
+		b, err := d.raw(8)
+		if err != nil {
+			return nil, err
+		}
+		return math.Float64frombits(binary.LittleEndian.Uint64(b)), nil
+	case tapeString, tapeOneByteString:
+		return d.string(tag)
+	case tapeBigInt:
+		sign, err := d.byte()
+		if err != nil {
+			return nil, err
+		}
+		n, err := d.count()
+		if err != nil {
+			return nil, err
+		}
+		b, err := d.raw(n * 8)
+		if err != nil {
+			return nil, err
+		}
+		words := make([]big.Word, n)
+		for i := range words {
+			words[i] = big.Word(binary.LittleEndian.Uint64(b[i*8:]))
+		}
+		bi := new(big.Int).SetBits(words)
+		if sign == 1 {
+			bi.Neg(bi)
+		}
+		return bi, nil
+	case tapeArray, tapeCyclicArray:
+		n, err := d.count()
+		if err != nil {
+			return nil, err
+		}
+		arr := make([]interface{}, n)
+		var self interface{}
+		if tag == tapeCyclicArray {
+			self = arr
+		}
+		d.path = append(d.path, self)
+		for i := range arr {
+			if arr[i], err = d.decode(depth + 1); err != nil {
+				return nil, err
+			}
+		}
+		d.path = d.path[:len(d.path)-1]
+		return arr, nil
+	case tapeObject, tapeCyclicObject:
+		n, err := d.count()
+		if err != nil {
+			return nil, err
+		}
+		obj := make(map[string]interface{}, n)
+		var self interface{}
+		if tag == tapeCyclicObject {
+			self = obj
+		}
+		d.path = append(d.path, self)
+		for i := 0; i < n; i++ {
+			key, err := d.key()
+			if err != nil {
+				return nil, err
+			}
+			if obj[key], err = d.decode(depth + 1); err != nil {
+				return nil, err
+			}
+		}
+		d.path = d.path[:len(d.path)-1]
+		return obj, nil
+	case tapeCycle:
+		n, err := d.uvarint()
+		if err != nil {
+			return nil, err
+		}
+		if n >= uint64(len(d.path)) || d.path[len(d.path)-1-int(n)] == nil {
+			return nil, errors.New("v8go: tape: invalid cycle reference")
+		}
+		return d.path[len(d.path)-1-int(n)], nil
+	case tapeBuffer:
+		return d.buffer()
+	}
+	return nil, fmt.Errorf("v8go: tape: unknown tag %d", tag)
+}
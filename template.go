@@ -19,6 +19,11 @@ import (
 type template struct {
 	ptr C.TemplatePtr
 	iso *Isolate
+
+	// the callback of a function template, unregistered by the finalizer
+	callback int
+	// the templates set on this one, which its instances are made of
+	children []*template
 }
 
 // Set adds a property to each instance created by this template.
@@ -43,10 +48,10 @@ func (t *template) Set(name string, val interface{}, attributes ...PropertyAttri
 		C.TemplateSetValue(t.ptr, cname, newVal.ptr, C.int(attrs))
 	case *ObjectTemplate:
 		C.TemplateSetTemplate(t.ptr, cname, v.ptr, C.int(attrs))
-		runtime.KeepAlive(v)
+		t.children = append(t.children, v.template)
 	case *FunctionTemplate:
 		C.TemplateSetTemplate(t.ptr, cname, v.ptr, C.int(attrs))
-		runtime.KeepAlive(v)
+		t.children = append(t.children, v.template)
 	case *Value:
 		if v.IsObject() || v.IsExternal() {
 			return errors.New("v8go: unsupported property: value type must be a primitive or use a template")
@@ -66,4 +71,9 @@ func (t *template) finalizer() {
 	// itself get cleaned up when the isolate is disposed.
 	C.TemplateFreeWrapper(t.ptr)
 	t.ptr = nil
+	// the functions of the template have gone with the contexts they were
+	// created in, as contexts keep the templates they use alive
+	if t.callback != 0 {
+		t.iso.unregisterCallbacks(t.callback)
+	}
 }
@@ -7,13 +7,62 @@ package v8go
 // #include <stdlib.h>
 // #include "v8go.h"
 import "C"
-import "unsafe"
+
+import (
+	"runtime"
+	"unsafe"
+)
 
 type UnboundScript struct {
 	ptr C.UnboundScriptPtr
 	iso *Isolate
 }
 
+func newUnboundScript(iso *Isolate, ptr C.UnboundScriptPtr) *UnboundScript {
+	us := &UnboundScript{ptr: ptr, iso: iso}
+	runtime.SetFinalizer(us, (*UnboundScript).finalize)
+	return us
+}
+
+// Release frees the compiled script. Otherwise the isolate keeps every script
+// compiled in it until it is disposed, or the UnboundScript is garbage
+// collected by Go. Running the script afterwards will panic.
+func (u *UnboundScript) Release() {
+	if u.ptr == nil {
+		return
+	}
+	if u.iso.ptr != nil {
+		C.UnboundScriptRelease(u.iso.ptr, u.ptr)
+	}
+	u.ptr = nil
+	runtime.SetFinalizer(u, nil)
+}
+
+// finalize queues the script to be released by the next call that enters the
+// isolate to compile or run a script, or to call a function, or by the next
+// Context.Close, as the finalizer goroutine must not block on an isolate that
+// is busy running JavaScript. An isolate that is no longer entered keeps the
+// queued scripts until it is disposed, which frees them with it.
+func (u *UnboundScript) finalize() {
+	u.iso.releaseMutex.Lock()
+	u.iso.releaseScripts = append(u.iso.releaseScripts, u.ptr)
+	u.iso.releaseMutex.Unlock()
+}
+
+func (i *Isolate) releasePendingScripts() {
+	i.releaseMutex.Lock()
+	if len(i.releaseScripts) == 0 {
+		i.releaseMutex.Unlock()
+		return
+	}
+	scripts := i.releaseScripts
+	i.releaseScripts = nil
+	i.releaseMutex.Unlock()
+	for _, ptr := range scripts {
+		C.UnboundScriptRelease(i.ptr, ptr)
+	}
+}
+
 // Run will bind the unbound script to the provided context and run it.
 // If the context provided does not belong to the same isolate that the script
 // was compiled in, Run will panic.
@@ -22,13 +71,22 @@ func (u *UnboundScript) Run(ctx *Context) (*Value, error) {
 	if ctx.Isolate() != u.iso {
 		panic("attempted to run unbound script in a context that belongs to a different isolate")
 	}
+	if u.ptr == nil {
+		panic("attempted to run unbound script that has been released")
+	}
+	u.iso.releasePendingScripts()
 	rtn := C.UnboundScriptRun(ctx.ptr, u.ptr)
+	runtime.KeepAlive(u)
 	return valueResult(ctx, rtn)
 }
 
 // Create a code cache from the unbound script.
 func (u *UnboundScript) CreateCodeCache() *CompilerCachedData {
+	if u.ptr == nil {
+		panic("attempted to create a code cache of unbound script that has been released")
+	}
 	rtn := C.UnboundScriptCreateCodeCache(u.iso.ptr, u.ptr)
+	runtime.KeepAlive(u)
 
 	cachedData := &CompilerCachedData{
 		Bytes:    C.GoBytes(unsafe.Pointer(rtn.data), rtn.length),
@@ -37,3 +95,45 @@ func (u *UnboundScript) CreateCodeCache() *CompilerCachedData {
 	C.ScriptCompilerCachedDataDelete(rtn)
 	return cachedData
 }
+
+// CodeCacheData is a code cache left in the C memory V8 produced it in, to
+// avoid copying it into Go. Bytes can be written out or passed back as
+// CompilerCachedData.Bytes directly.
+type CodeCacheData struct {
+	ptr *C.ScriptCompilerCachedData
+}
+
+// CreateCodeCacheData creates a code cache from the unbound script like
+// CreateCodeCache, without copying it. It must be freed with Free.
+func (u *UnboundScript) CreateCodeCacheData() *CodeCacheData {
+	if u.ptr == nil {
+		panic("attempted to create a code cache of unbound script that has been released")
+	}
+	d := &CodeCacheData{ptr: C.UnboundScriptCreateCodeCache(u.iso.ptr, u.ptr)}
+	runtime.KeepAlive(u)
+	runtime.SetFinalizer(d, (*CodeCacheData).Free)
+	return d
+}
+
+// Bytes returns the code cache. The slice is backed by C memory that must not
+// be written to, and stays valid until Free is called or the CodeCacheData is
+// garbage collected.
+func (d *CodeCacheData) Bytes() []byte {
+	if d.ptr == nil {
+		return nil
+	}
+	data := unsafe.Slice((*byte)(unsafe.Pointer(d.ptr.data)), int(d.ptr.length))
+	runtime.KeepAlive(d)
+	return data
+}
+
+// Free releases the memory of the code cache. Using its Bytes afterwards will
+// result in undefined behavior.
+func (d *CodeCacheData) Free() {
+	if d.ptr == nil {
+		return
+	}
+	C.ScriptCompilerCachedDataDelete(d.ptr)
+	d.ptr = nil
+	runtime.SetFinalizer(d, nil)
+}
@@ -5,7 +5,10 @@
 package v8go_test
 
 import (
+	"fmt"
+	"runtime"
 	"testing"
+	"time"
 
 	v8 "github.com/ionos-cloud/v8go"
 )
@@ -45,3 +48,66 @@ func TestUnboundScriptRun_OnlyInTheSameIsolate(t *testing.T) {
 		t.Error("expected panic running unbound script in a context belonging to a different isolate")
 	}
 }
+
+func TestUnboundScriptRelease(t *testing.T) {
+	t.Parallel()
+
+	iso := v8.NewIsolate()
+	defer iso.Dispose()
+	ctx := v8.NewContext(iso)
+	defer ctx.Close()
+
+	us, err := iso.CompileUnboundScript("1 + 1", "script.js", v8.CompileOptions{})
+	fatalIf(t, err)
+	us.Release()
+	// noop when called multiple times
+	us.Release()
+	if recoverPanic(func() { us.Run(ctx) }) == nil {
+		t.Error("expected panic running a released unbound script")
+	}
+	if recoverPanic(func() { us.CreateCodeCache() }) == nil {
+		t.Error("expected panic creating a code cache of a released unbound script")
+	}
+	if recoverPanic(func() { us.CreateCodeCacheData() }) == nil {
+		t.Error("expected panic creating a code cache of a released unbound script")
+	}
+
+	// scripts collected by Go are released by later compilations
+	for i := 0; i < 100; i++ {
+		_, err := iso.CompileUnboundScript(fmt.Sprintf("var tenant%d = %d", i, i), "tenant.js", v8.CompileOptions{})
+		fatalIf(t, err)
+		if i%10 == 0 {
+			runtime.GC()
+		}
+	}
+	us, err = iso.CompileUnboundScript("2 + 2", "script.js", v8.CompileOptions{})
+	fatalIf(t, err)
+	if val, err := us.Run(ctx); err != nil || val.Int32() != 4 {
+		t.Errorf("expected 4, got %v (%v)", val, err)
+	}
+
+	// as are those of an isolate that only runs scripts afterwards
+	for i := 0; i < 10; i++ {
+		_, err := iso.CompileUnboundScript("1", "dropped.js", v8.CompileOptions{})
+		fatalIf(t, err)
+	}
+	for start := time.Now(); iso.PendingScriptCount() < 10 && time.Since(start) < time.Second; {
+		runtime.GC()
+		time.Sleep(time.Millisecond)
+	}
+	if iso.PendingScriptCount() < 10 {
+		t.Fatal("expected dropped scripts to be queued for release")
+	}
+	_, err = ctx.RunScript("1", "run.js")
+	fatalIf(t, err)
+	if n := iso.PendingScriptCount(); n != 0 {
+		t.Errorf("expected RunScript to release the queued scripts, %d left", n)
+	}
+
+	// releasing after the isolate is disposed is a noop
+	iso2 := v8.NewIsolate()
+	us, err = iso2.CompileUnboundScript("1", "script.js", v8.CompileOptions{})
+	fatalIf(t, err)
+	iso2.Dispose()
+	us.Release()
+}
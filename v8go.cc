@@ -5,13 +5,19 @@
 #include "v8go.h"
 
 #include <stdio.h>
+#include <time.h>
 
+#include <atomic>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "_cgo_export.h"
@@ -25,10 +31,49 @@ const int ScriptCompilerNoCompileOptions = ScriptCompiler::kNoCompileOptions;
 const int ScriptCompilerConsumeCodeCache = ScriptCompiler::kConsumeCodeCache;
 const int ScriptCompilerEagerCompile = ScriptCompiler::kEagerCompile;
 
+const int GCCallbackFlagForced = kGCCallbackFlagForced;
+
+// m_usage accumulates the time spent in an isolate, or in one of its
+// contexts, as counted by UsageScope and CallbackScope.
+struct m_usage {
+  std::atomic<uint64_t> cpu_ns{0};
+  std::atomic<uint64_t> wall_ns{0};
+  std::atomic<uint64_t> entries{0};
+  std::atomic<uint64_t> callback_ns{0};
+  std::atomic<uint64_t> callbacks{0};
+
+  void Add(uint64_t cpu, uint64_t wall) {
+    cpu_ns.fetch_add(cpu, std::memory_order_relaxed);
+    wall_ns.fetch_add(wall, std::memory_order_relaxed);
+  }
+
+  ExecutionUsage Load() const {
+    return ExecutionUsage{cpu_ns.load(std::memory_order_relaxed),
+                          wall_ns.load(std::memory_order_relaxed),
+                          entries.load(std::memory_order_relaxed),
+                          callback_ns.load(std::memory_order_relaxed),
+                          callbacks.load(std::memory_order_relaxed)};
+  }
+};
+
+// m_closedMicrotaskQueue keeps the queue of a closed context alive for as long
+// as its native context, which may still be reachable from other contexts.
+struct m_closedMicrotaskQueue {
+  m_ctx* internal_ctx;
+  Global<Context> ptr;
+  std::unique_ptr<MicrotaskQueue> queue;
+};
+
 struct m_ctx {
   Isolate* iso;
+  m_usage usage;
   std::unordered_map<long, m_value*> vals;
-  std::vector<m_unboundScript*> unboundScripts;
+  std::unordered_set<m_unboundScript*> unboundScripts;
+  std::unordered_multimap<int, m_module*> modules;
+  std::unique_ptr<MicrotaskQueue> microtask_queue;
+  // the queues of closed contexts, kept by the internal context of the
+  // isolate until their native contexts are collected
+  std::unordered_set<m_closedMicrotaskQueue*> closed_microtask_queues;
   Persistent<Context> ptr;
   long nextValId;
 };
@@ -49,6 +94,55 @@ struct m_unboundScript {
   Persistent<UnboundScript> ptr;
 };
 
+struct m_module {
+  Persistent<Module> ptr;
+};
+
+struct m_locker {
+  Locker locker;
+  explicit m_locker(Isolate* iso) : locker(iso) {}
+};
+
+class UsageScope;
+
+struct m_unlocker {
+  Unlocker unlocker;
+  UsageScope* paused;
+  m_unlocker(Isolate* iso, UsageScope* scope)
+      : unlocker(iso), paused(scope) {}
+};
+
+// m_gcRecorder keeps the garbage collections of an isolate while GC tracking
+// is on: the latest events, for Go to take, and totals for each GC type.
+struct m_gcRecorder {
+  static const int kMaxEvents = 1024;
+  static const int kTypes = 5;
+
+  std::mutex mu;
+  // a ring of the latest events, overwriting the oldest once full
+  GCEvent events[kMaxEvents];
+  int head = 0;
+  int count = 0;
+  GCStats stats[kTypes] = {};
+  // the prologue of a GC type, until its epilogue
+  int64_t start[kTypes] = {};
+  uint64_t start_mono[kTypes] = {};
+  size_t used_before[kTypes] = {};
+};
+
+struct m_backingStore {
+  std::shared_ptr<BackingStore> ptr;
+};
+
+struct m_serializedValue {
+  uint8_t* data;
+  size_t length;
+  // transferred ArrayBuffers, handed to the first isolate that deserializes
+  std::vector<std::shared_ptr<BackingStore>> arrayBuffers;
+  bool transferred;
+  std::vector<std::shared_ptr<BackingStore>> sharedArrayBuffers;
+};
+
 const char* CopyString(std::string str) {
   int len = str.length();
   char* mem = (char*)malloc(len + 1);
@@ -106,6 +200,28 @@ static RtnError ExceptionError(TryCatch& try_catch,
   return rtn;
 }
 
+// RejectionError returns the reason a promise was rejected with as an error,
+// as if it had been thrown.
+static RtnError RejectionError(TryCatch& try_catch,
+                               Isolate* iso,
+                               Local<Context> ctx,
+                               Local<Promise> promise) {
+  promise->MarkAsHandled();
+  Local<Value> exception = promise->Result();
+  iso->ThrowException(exception);
+  RtnError rtn = ExceptionError(try_catch, iso, ctx);
+  Local<Value> stack;
+  if (rtn.stack == nullptr && exception->IsObject() &&
+      exception.As<Object>()
+          ->Get(ctx, String::NewFromUtf8Literal(iso, "stack"))
+          .ToLocal(&stack) &&
+      stack->IsString()) {
+    String::Utf8Value stack_str(iso, stack);
+    rtn.stack = CopyString(stack_str);
+  }
+  return rtn;
+}
+
 m_value* tracked_value(m_ctx* ctx, m_value* val) {
   // (rogchap) we track values against a context so that when the context is
   // closed (either manually or GC'd by Go) we can also release all the
@@ -119,11 +235,983 @@ m_value* tracked_value(m_ctx* ctx, m_value* val) {
 }
 
 m_unboundScript* tracked_unbound_script(m_ctx* ctx, m_unboundScript* us) {
-  ctx->unboundScripts.push_back(us);
+  ctx->unboundScripts.insert(us);
 
   return us;
 }
 
+/********** ArrayBuffer::Allocator **********/
+
+// IsolateAllocator is the ArrayBuffer allocator of a single isolate. It
+// accounts for the memory the isolate's buffers hold, can cap it so that
+// allocations fail instead of the process running out of memory, and can pool
+// freed buffers of common sizes. The memory itself comes from the default
+// allocator, which places it inside the V8 sandbox.
+class IsolateAllocator : public ArrayBuffer::Allocator {
+ public:
+  IsolateAllocator(size_t max_bytes, bool pooling)
+      : max_bytes_(max_bytes), pooling_(pooling) {}
+
+  ~IsolateAllocator() override {
+    for (int i = 0; i < kPoolClasses; i++) {
+      for (void* data : pools_[i]) {
+        default_allocator->Free(data, size_t(1) << (i + kPoolMinShift));
+      }
+    }
+  }
+
+  void* Allocate(size_t length) override {
+    if (!Reserve(length)) {
+      return nullptr;
+    }
+    void* data = TakePooled(length);
+    if (data != nullptr) {
+      memset(data, 0, length);
+      return data;
+    }
+    data = default_allocator->Allocate(AllocationSize(length));
+    if (data == nullptr) {
+      Unreserve(length);
+    }
+    return data;
+  }
+
+  void* AllocateUninitialized(size_t length) override {
+    if (!Reserve(length)) {
+      return nullptr;
+    }
+    void* data = TakePooled(length);
+    if (data != nullptr) {
+      return data;
+    }
+    data = default_allocator->AllocateUninitialized(AllocationSize(length));
+    if (data == nullptr) {
+      Unreserve(length);
+    }
+    return data;
+  }
+
+  void Free(void* data, size_t length) override {
+    Unreserve(length);
+    if (!PutPooled(data, length)) {
+      default_allocator->Free(data, AllocationSize(length));
+    }
+  }
+
+  // CanAllocate reports whether an allocation of length bytes fits under the
+  // cap, for API calls where V8 treats a failed allocation as fatal.
+  bool CanAllocate(size_t length) const {
+    return max_bytes_ == 0 || allocated_.load() + length <= max_bytes_;
+  }
+
+  size_t allocated() const { return allocated_.load(); }
+  size_t peak() const { return peak_.load(); }
+  size_t failed() const { return failed_.load(); }
+  size_t pooled() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pooled_bytes_;
+  }
+
+ private:
+  // Buffers from 64 bytes to 64 KiB are pooled in power of two size classes,
+  // keeping at most kPoolMaxBytes per isolate.
+  static const int kPoolMinShift = 6;
+  static const int kPoolMaxShift = 16;
+  static const int kPoolClasses = kPoolMaxShift - kPoolMinShift + 1;
+  static const size_t kPoolMaxBytes = 4 << 20;
+
+  static int PoolClass(size_t length) {
+    int shift = kPoolMinShift;
+    while ((size_t(1) << shift) < length) {
+      shift++;
+    }
+    return shift - kPoolMinShift;
+  }
+
+  bool Pooled(size_t length) const {
+    return pooling_ && length <= (size_t(1) << kPoolMaxShift);
+  }
+
+  size_t AllocationSize(size_t length) const {
+    if (!Pooled(length)) {
+      return length;
+    }
+    return size_t(1) << (PoolClass(length) + kPoolMinShift);
+  }
+
+  void* TakePooled(size_t length) {
+    if (!Pooled(length)) {
+      return nullptr;
+    }
+    int c = PoolClass(length);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pools_[c].empty()) {
+      return nullptr;
+    }
+    void* data = pools_[c].back();
+    pools_[c].pop_back();
+    pooled_bytes_ -= size_t(1) << (c + kPoolMinShift);
+    return data;
+  }
+
+  bool PutPooled(void* data, size_t length) {
+    if (!Pooled(length)) {
+      return false;
+    }
+    int c = PoolClass(length);
+    size_t size = size_t(1) << (c + kPoolMinShift);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pooled_bytes_ + size > kPoolMaxBytes) {
+      return false;
+    }
+    pools_[c].push_back(data);
+    pooled_bytes_ += size;
+    return true;
+  }
+
+  bool Reserve(size_t length) {
+    size_t total = allocated_.fetch_add(length) + length;
+    if (max_bytes_ != 0 && total > max_bytes_) {
+      allocated_.fetch_sub(length);
+      failed_.fetch_add(1);
+      return false;
+    }
+    size_t peak = peak_.load();
+    while (total > peak && !peak_.compare_exchange_weak(peak, total)) {
+    }
+    return true;
+  }
+
+  void Unreserve(size_t length) { allocated_.fetch_sub(length); }
+
+  const size_t max_bytes_;
+  const bool pooling_;
+  std::atomic<size_t> allocated_{0};
+  std::atomic<size_t> peak_{0};
+  std::atomic<size_t> failed_{0};
+  std::mutex mutex_;
+  std::vector<void*> pools_[kPoolClasses];
+  size_t pooled_bytes_ = 0;
+};
+
+static IsolateAllocator* isolateAllocator(Isolate* iso) {
+  return static_cast<IsolateAllocator*>(iso->GetArrayBufferAllocator());
+}
+
+/********** Tape **********/
+
+// The tape is a flat, tagged encoding of a value graph that lets a whole Go
+// value be built in JS (or the reverse) with a single cgo crossing, instead of
+// one call per node. See tape.go for the layout of each tag.
+
+static const int kTapeMaxDepth = 1000;
+
+class TapeReader {
+ public:
+  TapeReader(Isolate* iso,
+             Local<Context> ctx,
+             const uint8_t* data,
+             int length)
+      : iso_(iso), ctx_(ctx), pos_(data), end_(data + length) {}
+
+  bool Read(Local<Value>* out) {
+    object_prototype_ = Object::New(iso_)->GetPrototype();
+    if (!ReadValue(out, 0)) {
+      return false;
+    }
+    if (pos_ != end_) {
+      return Fail("tape: trailing data after value");
+    }
+    return true;
+  }
+
+  const char* error() const { return error_; }
+
+ private:
+  bool Fail(const char* msg) {
+    if (error_ == nullptr) {
+      error_ = msg;
+    }
+    return false;
+  }
+
+  bool ReadByte(uint8_t* b) {
+    if (pos_ >= end_) {
+      return Fail("tape: unexpected end of data");
+    }
+    *b = *pos_++;
+    return true;
+  }
+
+  bool ReadUvarint(uint64_t* v) {
+    uint64_t x = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      uint8_t b;
+      if (!ReadByte(&b)) {
+        return false;
+      }
+      x |= uint64_t(b & 0x7f) << shift;
+      if (b < 0x80) {
+        *v = x;
+        return true;
+      }
+    }
+    return Fail("tape: varint overflows 64 bits");
+  }
+
+  // ReadCount reads an element count; every element takes at least one byte
+  // so anything larger than the remaining data is malformed.
+  bool ReadCount(size_t* n) {
+    uint64_t v;
+    if (!ReadUvarint(&v)) {
+      return false;
+    }
+    if (v > uint64_t(end_ - pos_)) {
+      return Fail("tape: count exceeds remaining data");
+    }
+    *n = v;
+    return true;
+  }
+
+  bool ReadRaw(size_t n, const uint8_t** p) {
+    if (n > size_t(end_ - pos_)) {
+      return Fail("tape: unexpected end of data");
+    }
+    *p = pos_;
+    pos_ += n;
+    return true;
+  }
+
+  bool ReadString(uint8_t tag, NewStringType type, Local<String>* out) {
+    size_t n;
+    const uint8_t* p;
+    if (!ReadCount(&n) || !ReadRaw(n, &p)) {
+      return false;
+    }
+    MaybeLocal<String> str =
+        tag == TapeOneByteString
+            ? String::NewFromOneByte(iso_, p, type, n)
+            : String::NewFromUtf8(iso_, reinterpret_cast<const char*>(p), type,
+                                  n);
+    if (!str.ToLocal(out)) {
+      return Fail("tape: string too long");
+    }
+    return true;
+  }
+
+  // ReadKey reads a property name. Payloads tend to repeat the same keys for
+  // every element of an array, so UTF-8 names are also cached by their tape
+  // bytes to skip the string table lookup of internalizing them again when
+  // the writer did not use a TapeKeyRef.
+  bool ReadKey(Local<Name>* out) {
+    uint8_t tag;
+    if (!ReadByte(&tag)) {
+      return false;
+    }
+    if (tag == TapeKeyRef) {
+      uint64_t i;
+      if (!ReadUvarint(&i)) {
+        return false;
+      }
+      if (i >= key_table_.size()) {
+        return Fail("tape: invalid key reference");
+      }
+      *out = key_table_[i];
+      return true;
+    }
+    if (tag == TapeOneByteString) {
+      Local<String> key;
+      if (!ReadString(tag, NewStringType::kInternalized, &key)) {
+        return false;
+      }
+      key_table_.push_back(key);
+      *out = key;
+      return true;
+    }
+    if (tag != TapeString) {
+      return Fail("tape: invalid key");
+    }
+
+    size_t n;
+    const uint8_t* p;
+    if (!ReadCount(&n) || !ReadRaw(n, &p)) {
+      return false;
+    }
+    std::string_view bytes(reinterpret_cast<const char*>(p), n);
+    Local<String> key;
+    auto it = keys_.find(bytes);
+    if (it != keys_.end()) {
+      key = it->second;
+    } else {
+      if (!String::NewFromUtf8(iso_, bytes.data(),
+                               NewStringType::kInternalized, n)
+               .ToLocal(&key)) {
+        return Fail("tape: string too long");
+      }
+      keys_.emplace(bytes, key);
+    }
+    key_table_.push_back(key);
+    *out = key;
+    return true;
+  }
+
+  template <class T>
+  bool NewTypedArray(Local<ArrayBuffer> buf,
+                     size_t element_size,
+                     Local<Value>* out) {
+    size_t n = buf->ByteLength();
+    if (n % element_size != 0) {
+      return Fail("tape: buffer length is not a multiple of its element size");
+    }
+    *out = T::New(buf, 0, n / element_size);
+    return true;
+  }
+
+  bool ReadBuffer(Local<Value>* out) {
+    uint8_t kind;
+    size_t n;
+    const uint8_t* p;
+    if (!ReadByte(&kind) || !ReadCount(&n) || !ReadRaw(n, &p)) {
+      return false;
+    }
+    // ArrayBuffer::New treats a failed allocation as out of memory
+    if (!isolateAllocator(iso_)->CanAllocate(n)) {
+      return Fail("RangeError: Array buffer allocation failed");
+    }
+    Local<ArrayBuffer> buf = ArrayBuffer::New(iso_, n);
+    if (n > 0) {
+      memcpy(buf->Data(), p, n);
+    }
+    switch (kind) {
+      case TapeArrayBufferKind:
+        *out = buf;
+        return true;
+      case TapeUint8ArrayKind:
+        return NewTypedArray<Uint8Array>(buf, 1, out);
+      case TapeUint8ClampedArrayKind:
+        return NewTypedArray<Uint8ClampedArray>(buf, 1, out);
+      case TapeInt8ArrayKind:
+        return NewTypedArray<Int8Array>(buf, 1, out);
+      case TapeUint16ArrayKind:
+        return NewTypedArray<Uint16Array>(buf, 2, out);
+      case TapeInt16ArrayKind:
+        return NewTypedArray<Int16Array>(buf, 2, out);
+      case TapeUint32ArrayKind:
+        return NewTypedArray<Uint32Array>(buf, 4, out);
+      case TapeInt32ArrayKind:
+        return NewTypedArray<Int32Array>(buf, 4, out);
+      case TapeFloat32ArrayKind:
+        return NewTypedArray<Float32Array>(buf, 4, out);
+      case TapeFloat64ArrayKind:
+        return NewTypedArray<Float64Array>(buf, 8, out);
+      case TapeBigInt64ArrayKind:
+        return NewTypedArray<BigInt64Array>(buf, 8, out);
+      case TapeBigUint64ArrayKind:
+        return NewTypedArray<BigUint64Array>(buf, 8, out);
+      default:
+        return Fail("tape: unknown buffer kind");
+    }
+  }
+
+  // A cyclic container is referenced by one of its descendants, so unlike
+  // the bulk construction below it has to exist before its elements are read
+  // and is filled in one property at a time.
+  bool ReadCyclicArray(size_t n, Local<Value>* out, int depth) {
+    Local<Array> arr = Array::New(iso_, n);
+    path_.push_back(arr);
+    for (size_t i = 0; i < n; i++) {
+      Local<Value> element;
+      if (!ReadValue(&element, depth + 1) ||
+          !arr->CreateDataProperty(ctx_, i, element).FromMaybe(false)) {
+        return false;
+      }
+    }
+    path_.pop_back();
+    *out = arr;
+    return true;
+  }
+
+  bool ReadCyclicObject(size_t n, Local<Value>* out, int depth) {
+    Local<Object> obj = Object::New(iso_);
+    path_.push_back(obj);
+    for (size_t i = 0; i < n; i++) {
+      Local<Name> key;
+      Local<Value> element;
+      if (!ReadKey(&key) || !ReadValue(&element, depth + 1) ||
+          !obj->CreateDataProperty(ctx_, key, element).FromMaybe(false)) {
+        return false;
+      }
+    }
+    path_.pop_back();
+    *out = obj;
+    return true;
+  }
+
+  bool ReadValue(Local<Value>* out, int depth) {
+    if (depth > kTapeMaxDepth) {
+      return Fail("tape: value nested too deeply");
+    }
+    uint8_t tag;
+    if (!ReadByte(&tag)) {
+      return false;
+    }
+    switch (tag) {
+      case TapeUndefined:
+        *out = Undefined(iso_);
+        return true;
+      case TapeNull:
+        *out = Null(iso_);
+        return true;
+      case TapeFalse:
+        *out = False(iso_);
+        return true;
+      case TapeTrue:
+        *out = True(iso_);
+        return true;
+      case TapeInt32: {
+        uint64_t v;
+        if (!ReadUvarint(&v)) {
+          return false;
+        }
+        // zig-zag decoding, matching encoding/binary.PutVarint
+        int64_t i = int64_t(v >> 1) ^ -int64_t(v & 1);
+        *out = Integer::New(iso_, int32_t(i));
+        return true;
+      }
+      case TapeFloat64: {
+        const uint8_t* p;
+        if (!ReadRaw(sizeof(double), &p)) {
+          return false;
+        }
+        double d;
+        memcpy(&d, p, sizeof(double));
+        *out = Number::New(iso_, d);
+        return true;
+      }
+      case TapeString:
+      case TapeOneByteString: {
+        Local<String> str;
+        if (!ReadString(tag, NewStringType::kNormal, &str)) {
+          return false;
+        }
+        *out = str;
+        return true;
+      }
+      case TapeBigInt: {
+        uint8_t sign;
+        size_t count;
+        const uint8_t* p;
+        if (!ReadByte(&sign) || !ReadCount(&count) ||
+            !ReadRaw(count * sizeof(uint64_t), &p)) {
+          return false;
+        }
+        std::vector<uint64_t> words(count);
+        memcpy(words.data(), p, count * sizeof(uint64_t));
+        Local<BigInt> bigint;
+        if (!BigInt::NewFromWords(ctx_, sign, count, words.data())
+                 .ToLocal(&bigint)) {
+          return Fail("tape: invalid bigint");
+        }
+        *out = bigint;
+        return true;
+      }
+      case TapeArray: {
+        size_t n;
+        if (!ReadCount(&n)) {
+          return false;
+        }
+        // an empty slot keeps the distances of TapeCycle references right
+        path_.emplace_back();
+        std::vector<Local<Value>> elements(n);
+        for (size_t i = 0; i < n; i++) {
+          if (!ReadValue(&elements[i], depth + 1)) {
+            return false;
+          }
+        }
+        path_.pop_back();
+        *out = Array::New(iso_, elements.data(), n);
+        return true;
+      }
+      case TapeObject: {
+        size_t n;
+        if (!ReadCount(&n)) {
+          return false;
+        }
+        path_.emplace_back();
+        std::vector<Local<Name>> names(n);
+        std::vector<Local<Value>> values(n);
+        for (size_t i = 0; i < n; i++) {
+          if (!ReadKey(&names[i]) || !ReadValue(&values[i], depth + 1)) {
+            return false;
+          }
+        }
+        path_.pop_back();
+        *out = Object::New(iso_, object_prototype_, names.data(),
+                           values.data(), n);
+        return true;
+      }
+      case TapeCyclicArray:
+      case TapeCyclicObject: {
+        size_t n;
+        if (!ReadCount(&n)) {
+          return false;
+        }
+        return tag == TapeCyclicArray ? ReadCyclicArray(n, out, depth)
+                                      : ReadCyclicObject(n, out, depth);
+      }
+      case TapeCycle: {
+        uint64_t d;
+        if (!ReadUvarint(&d)) {
+          return false;
+        }
+        if (d >= path_.size() || path_[path_.size() - 1 - d].IsEmpty()) {
+          return Fail("tape: invalid cycle reference");
+        }
+        *out = path_[path_.size() - 1 - d];
+        return true;
+      }
+      case TapeBuffer:
+        return ReadBuffer(out);
+      case TapeValueRef: {
+        const uint8_t* p;
+        if (!ReadRaw(sizeof(m_value*), &p)) {
+          return false;
+        }
+        m_value* val;
+        memcpy(&val, p, sizeof(m_value*));
+        if (val == nullptr || val->iso != iso_) {
+          return Fail("tape: value belongs to a different isolate");
+        }
+        *out = val->ptr.Get(iso_);
+        return true;
+      }
+      default:
+        return Fail("tape: unknown tag");
+    }
+  }
+
+  Isolate* iso_;
+  Local<Context> ctx_;
+  Local<Value> object_prototype_;
+  std::unordered_map<std::string_view, Local<String>> keys_;
+  std::vector<Local<Name>> key_table_;
+  // the enclosing containers, empty unless a TapeCycle may refer to them
+  std::vector<Local<Object>> path_;
+  const uint8_t* pos_;
+  const uint8_t* end_;
+  const char* error_ = nullptr;
+};
+
+class TapeWriter {
+ public:
+  TapeWriter(Isolate* iso, Local<Context> ctx) : iso_(iso), ctx_(ctx) {}
+  ~TapeWriter() { free(buf_); }
+
+  bool Write(Local<Value> value) { return WriteValue(value, 0); }
+
+  // Release hands the malloc'ed buffer over to the caller.
+  const uint8_t* Release(int* length) {
+    uint8_t* buf = buf_;
+    *length = len_;
+    buf_ = nullptr;
+    len_ = cap_ = 0;
+    return buf;
+  }
+
+  const char* error() const { return error_; }
+
+ private:
+  bool Fail(const char* msg) {
+    if (error_ == nullptr) {
+      error_ = msg;
+    }
+    return false;
+  }
+
+  void Reserve(size_t n) {
+    if (len_ + n <= cap_) {
+      return;
+    }
+    size_t cap = cap_ < 64 ? 64 : cap_ * 2;
+    while (cap < len_ + n) {
+      cap *= 2;
+    }
+    buf_ = static_cast<uint8_t*>(realloc(buf_, cap));
+    cap_ = cap;
+  }
+
+  void WriteByte(uint8_t b) {
+    Reserve(1);
+    buf_[len_++] = b;
+  }
+
+  void WriteUvarint(uint64_t v) {
+    Reserve(10);
+    while (v >= 0x80) {
+      buf_[len_++] = uint8_t(v) | 0x80;
+      v >>= 7;
+    }
+    buf_[len_++] = uint8_t(v);
+  }
+
+  void WriteRaw(const void* p, size_t n) {
+    Reserve(n);
+    memcpy(buf_ + len_, p, n);
+    len_ += n;
+  }
+
+  // WriteString writes one-byte strings as Latin-1, which is a plain copy out
+  // of the V8 heap, and only transcodes two-byte strings to UTF-8.
+  void WriteString(Local<String> str) {
+    if (str->IsOneByte()) {
+      int n = str->Length();
+      WriteByte(TapeOneByteString);
+      WriteUvarint(n);
+      Reserve(n);
+      str->WriteOneByte(iso_, buf_ + len_, 0, n, String::NO_NULL_TERMINATION);
+      len_ += n;
+      return;
+    }
+    int n = str->Utf8Length(iso_);
+    WriteByte(TapeString);
+    WriteUvarint(n);
+    Reserve(n);
+    str->WriteUtf8(iso_, reinterpret_cast<char*>(buf_ + len_), n, nullptr,
+                   String::NO_NULL_TERMINATION | String::REPLACE_INVALID_UTF8);
+    len_ += n;
+  }
+
+  // WriteKey writes each distinct property name once and refers back to it by
+  // index afterwards.
+  void WriteKey(Local<String> key) {
+    int hash = key->GetIdentityHash();
+    auto range = keys_.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second.first->StrictEquals(key)) {
+        WriteByte(TapeKeyRef);
+        WriteUvarint(it->second.second);
+        return;
+      }
+    }
+    keys_.emplace(hash, std::make_pair(key, uint32_t(keys_.size())));
+    WriteString(key);
+  }
+
+  static uint8_t BufferKind(Local<ArrayBufferView> view) {
+    if (view->IsUint8Array()) {
+      return TapeUint8ArrayKind;
+    } else if (view->IsUint8ClampedArray()) {
+      return TapeUint8ClampedArrayKind;
+    } else if (view->IsInt8Array()) {
+      return TapeInt8ArrayKind;
+    } else if (view->IsUint16Array()) {
+      return TapeUint16ArrayKind;
+    } else if (view->IsInt16Array()) {
+      return TapeInt16ArrayKind;
+    } else if (view->IsUint32Array()) {
+      return TapeUint32ArrayKind;
+    } else if (view->IsInt32Array()) {
+      return TapeInt32ArrayKind;
+    } else if (view->IsFloat32Array()) {
+      return TapeFloat32ArrayKind;
+    } else if (view->IsFloat64Array()) {
+      return TapeFloat64ArrayKind;
+    } else if (view->IsBigInt64Array()) {
+      return TapeBigInt64ArrayKind;
+    } else if (view->IsBigUint64Array()) {
+      return TapeBigUint64ArrayKind;
+    }
+    // DataView
+    return TapeArrayBufferKind;
+  }
+
+  void WriteBuffer(Local<ArrayBufferView> view) {
+    size_t n = view->ByteLength();
+    WriteByte(TapeBuffer);
+    WriteByte(BufferKind(view));
+    WriteUvarint(n);
+    Reserve(n);
+    len_ += view->CopyContents(buf_ + len_, n);
+  }
+
+  bool WriteValue(Local<Value> value, int depth) {
+    if (depth > kTapeMaxDepth) {
+      return Fail("tape: value nested too deeply");
+    }
+    if (value->IsNull()) {
+      WriteByte(TapeNull);
+    } else if (value->IsTrue()) {
+      WriteByte(TapeTrue);
+    } else if (value->IsFalse()) {
+      WriteByte(TapeFalse);
+    } else if (value->IsInt32()) {
+      int64_t i = value.As<Int32>()->Value();
+      WriteByte(TapeInt32);
+      WriteUvarint(uint64_t(i << 1) ^ uint64_t(i >> 63));
+    } else if (value->IsNumber()) {
+      double d = value.As<Number>()->Value();
+      WriteByte(TapeFloat64);
+      WriteRaw(&d, sizeof(double));
+    } else if (value->IsString()) {
+      WriteString(value.As<String>());
+    } else if (value->IsBigInt()) {
+      Local<BigInt> bigint = value.As<BigInt>();
+      int count = bigint->WordCount();
+      int sign = 0;
+      std::vector<uint64_t> words(count);
+      bigint->ToWordsArray(&sign, &count, words.data());
+      WriteByte(TapeBigInt);
+      WriteByte(sign);
+      WriteUvarint(count);
+      WriteRaw(words.data(), count * sizeof(uint64_t));
+    } else if (value->IsArrayBufferView()) {
+      WriteBuffer(value.As<ArrayBufferView>());
+    } else if (value->IsArrayBuffer()) {
+      Local<ArrayBuffer> buf = value.As<ArrayBuffer>();
+      size_t n = buf->ByteLength();
+      WriteByte(TapeBuffer);
+      WriteByte(TapeArrayBufferKind);
+      WriteUvarint(n);
+      if (n > 0) {
+        WriteRaw(buf->Data(), n);
+      }
+    } else if (value->IsArray()) {
+      return WriteArray(value.As<Array>(), depth);
+    } else if (value->IsObject() && !value->IsFunction()) {
+      return WriteObject(value.As<Object>(), depth);
+    } else {
+      // undefined, functions and symbols have no Go equivalent
+      WriteByte(TapeUndefined);
+    }
+    return true;
+  }
+
+  // WriteCycle writes a reference to obj if it is one of the containers being
+  // written, and marks that container as cyclic so that the reader creates it
+  // before its elements.
+  bool WriteCycle(Local<Object> obj) {
+    for (size_t i = path_.size(); i-- > 0;) {
+      if (path_[i].first->StrictEquals(obj)) {
+        uint8_t* tag = buf_ + path_[i].second;
+        *tag = *tag == TapeArray ? TapeCyclicArray : TapeCyclicObject;
+        WriteByte(TapeCycle);
+        WriteUvarint(path_.size() - 1 - i);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool WriteArray(Local<Array> arr, int depth) {
+    if (WriteCycle(arr)) {
+      return true;
+    }
+    uint32_t n = arr->Length();
+    path_.emplace_back(arr, len_);
+    WriteByte(TapeArray);
+    WriteUvarint(n);
+    for (uint32_t i = 0; i < n; i++) {
+      Local<Value> element;
+      if (!arr->Get(ctx_, i).ToLocal(&element) ||
+          !WriteValue(element, depth + 1)) {
+        return false;
+      }
+    }
+    path_.pop_back();
+    return true;
+  }
+
+  bool WriteObject(Local<Object> obj, int depth) {
+    if (WriteCycle(obj)) {
+      return true;
+    }
+    Local<Array> keys;
+    if (!obj->GetOwnPropertyNames(
+                ctx_,
+                static_cast<PropertyFilter>(ONLY_ENUMERABLE | SKIP_SYMBOLS),
+                KeyConversionMode::kConvertToString)
+             .ToLocal(&keys)) {
+      return false;
+    }
+    uint32_t n = keys->Length();
+    path_.emplace_back(obj, len_);
+    WriteByte(TapeObject);
+    WriteUvarint(n);
+    for (uint32_t i = 0; i < n; i++) {
+      Local<Value> key, element;
+      if (!keys->Get(ctx_, i).ToLocal(&key) ||
+          !obj->Get(ctx_, key).ToLocal(&element)) {
+        return false;
+      }
+      WriteKey(key.As<String>());
+      if (!WriteValue(element, depth + 1)) {
+        return false;
+      }
+    }
+    path_.pop_back();
+    return true;
+  }
+
+  Isolate* iso_;
+  Local<Context> ctx_;
+  // the containers being written and the offsets of their tags
+  std::vector<std::pair<Local<Object>, size_t>> path_;
+  std::unordered_multimap<int, std::pair<Local<String>, uint32_t>> keys_;
+  uint8_t* buf_ = nullptr;
+  size_t len_ = 0;
+  size_t cap_ = 0;
+  const char* error_ = nullptr;
+};
+
+/********** Serializer **********/
+
+class SerializerDelegate : public ValueSerializer::Delegate {
+ public:
+  SerializerDelegate(Isolate* iso, m_serializedValue* out)
+      : iso_(iso), out_(out) {}
+
+  void ThrowDataCloneError(Local<String> message) override {
+    iso_->ThrowException(Exception::Error(message));
+  }
+
+  // SharedArrayBuffers are passed by reference to their backing store, so the
+  // deserialized buffer shares its memory with the original.
+  Maybe<uint32_t> GetSharedArrayBufferId(
+      Isolate* iso,
+      Local<SharedArrayBuffer> shared_array_buffer) override {
+    std::shared_ptr<BackingStore> store =
+        shared_array_buffer->GetBackingStore();
+    std::vector<std::shared_ptr<BackingStore>>& stores =
+        out_->sharedArrayBuffers;
+    for (size_t i = 0; i < stores.size(); i++) {
+      if (stores[i].get() == store.get()) {
+        return Just<uint32_t>(i);
+      }
+    }
+    stores.push_back(std::move(store));
+    return Just<uint32_t>(stores.size() - 1);
+  }
+
+ private:
+  Isolate* iso_;
+  m_serializedValue* out_;
+};
+
+class DeserializerDelegate : public ValueDeserializer::Delegate {
+ public:
+  explicit DeserializerDelegate(m_serializedValue* in) : in_(in) {}
+
+  MaybeLocal<SharedArrayBuffer> GetSharedArrayBufferFromId(
+      Isolate* iso,
+      uint32_t clone_id) override {
+    if (clone_id >= in_->sharedArrayBuffers.size()) {
+      iso->ThrowException(Exception::Error(
+          String::NewFromUtf8Literal(iso, "invalid SharedArrayBuffer id")));
+      return MaybeLocal<SharedArrayBuffer>();
+    }
+    return SharedArrayBuffer::New(iso, in_->sharedArrayBuffers[clone_id]);
+  }
+
+ private:
+  m_serializedValue* in_;
+};
+
+static inline uint64_t clockNanos(clockid_t clock) {
+  timespec ts;
+  clock_gettime(clock, &ts);
+  return uint64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// UsageScope counts the CPU and wall time of a call into an isolate, for the
+// isolate and for the context it enters. Reading the CPU clock of a thread is
+// a system call, so only the calls that run JavaScript are counted, rather
+// than every accessor. Only the outermost scope of each thread counts, so
+// calls made from Go callbacks are part of the call that ran the callback.
+class UsageScope {
+ public:
+  UsageScope(Isolate* iso, m_ctx* ctx)
+      : iso_(iso), ctx_(ctx), outer_(current_) {
+    if (outer_ != nullptr && outer_->iso_ == iso) {
+      nested_ = true;
+      return;
+    }
+    current_ = this;
+    Usage(&m_usage::entries);
+    Start();
+  }
+
+  ~UsageScope() {
+    if (nested_) {
+      return;
+    }
+    Stop();
+    current_ = outer_;
+  }
+
+  // Pause stops counting while the isolate is released by the current thread,
+  // returning the scope to Resume once it holds the isolate again.
+  static UsageScope* Pause(Isolate* iso) {
+    UsageScope* scope = current_;
+    if (scope == nullptr || scope->iso_ != iso) {
+      return nullptr;
+    }
+    scope->Stop();
+    return scope;
+  }
+
+  static void Resume(UsageScope* scope) {
+    if (scope != nullptr) {
+      scope->Start();
+    }
+  }
+
+  void Usage(std::atomic<uint64_t> m_usage::*counter, uint64_t n = 1) {
+    m_ctx* internal = static_cast<m_ctx*>(iso_->GetData(0));
+    (internal->usage.*counter).fetch_add(n, std::memory_order_relaxed);
+    if (ctx_ != nullptr && ctx_ != internal) {
+      (ctx_->usage.*counter).fetch_add(n, std::memory_order_relaxed);
+    }
+  }
+
+ private:
+  void Start() {
+    wall_ = clockNanos(CLOCK_MONOTONIC);
+    cpu_ = clockNanos(CLOCK_THREAD_CPUTIME_ID);
+  }
+
+  void Stop() {
+    Usage(&m_usage::cpu_ns, clockNanos(CLOCK_THREAD_CPUTIME_ID) - cpu_);
+    Usage(&m_usage::wall_ns, clockNanos(CLOCK_MONOTONIC) - wall_);
+  }
+
+  Isolate* iso_;
+  m_ctx* ctx_;
+  UsageScope* outer_;
+  bool nested_ = false;
+  uint64_t wall_ = 0;
+  uint64_t cpu_ = 0;
+
+  static thread_local UsageScope* current_;
+};
+
+thread_local UsageScope* UsageScope::current_ = nullptr;
+
+// CallbackScope counts the wall time of a call from V8 into Go.
+class CallbackScope {
+ public:
+  CallbackScope(Isolate* iso, m_ctx* ctx)
+      : scope_(iso, ctx), start_(clockNanos(CLOCK_MONOTONIC)) {}
+
+  ~CallbackScope() {
+    scope_.Usage(&m_usage::callbacks);
+    scope_.Usage(&m_usage::callback_ns, clockNanos(CLOCK_MONOTONIC) - start_);
+  }
+
+ private:
+  UsageScope scope_;
+  uint64_t start_;
+};
+
 extern "C" {
 
 /********** Isolate **********/
@@ -148,15 +1236,30 @@ void Init() {
   return;
 }
 
-IsolatePtr NewIsolate() {
+static MaybeLocal<Promise> DynamicImportCallback(
+    Local<Context> local_ctx,
+    Local<Data> host_defined_options,
+    Local<Value> resource_name,
+    Local<String> specifier,
+    Local<FixedArray> import_assertions);
+static void ImportMetaCallback(Local<Context> local_ctx,
+                               Local<Module> module,
+                               Local<Object> meta);
+
+IsolatePtr NewIsolate(IsolateOptions options) {
   Isolate::CreateParams params;
-  params.array_buffer_allocator = default_allocator;
+  // Backing stores keep a reference to the allocator, so it outlives the
+  // isolate for as long as any of its buffers are still in use elsewhere.
+  params.array_buffer_allocator_shared = std::make_shared<IsolateAllocator>(
+      options.arrayBufferMaxBytes, options.arrayBufferPooling);
   Isolate* iso = Isolate::New(params);
   Locker locker(iso);
   Isolate::Scope isolate_scope(iso);
   HandleScope handle_scope(iso);
 
   iso->SetCaptureStackTraceForUncaughtExceptions(true);
+  iso->SetHostImportModuleDynamicallyCallback(DynamicImportCallback);
+  iso->SetHostInitializeImportMetaObjectCallback(ImportMetaCallback);
 
   // Create a Context for internal use
   m_ctx* ctx = new m_ctx;
@@ -181,6 +1284,7 @@ void IsolateDispose(IsolatePtr iso) {
     return;
   }
   ContextFree(isolateInternalContext(iso));
+  IsolateStopGCTracking(iso);
 
   iso->Dispose();
 }
@@ -189,6 +1293,50 @@ void IsolateTerminateExecution(IsolatePtr iso) {
   iso->TerminateExecution();
 }
 
+void IsolateCancelTerminateExecution(IsolatePtr iso) {
+  iso->CancelTerminateExecution();
+}
+
+// IsolateLock holds the isolate for the calls of the current thread until
+// IsolateUnlock, which must be called from the same thread, as the Lockers of
+// those calls are then nested in this one.
+LockerPtr IsolateLock(IsolatePtr iso) {
+  return new m_locker(iso);
+}
+
+void IsolateUnlock(LockerPtr ptr) {
+  delete ptr;
+}
+
+static void InterruptHook(Isolate* iso, void* data) {
+  goInterrupt(static_cast<int>(reinterpret_cast<intptr_t>(data)));
+}
+
+void IsolateRequestInterrupt(IsolatePtr iso, int ref) {
+  iso->RequestInterrupt(InterruptHook,
+                        reinterpret_cast<void*>(static_cast<intptr_t>(ref)));
+}
+
+// IsolateYield releases the isolate held by the current thread, however many
+// Lockers it is nested in, with the state of its paused JavaScript archived
+// until IsolateResume, which must be called from the same thread.
+UnlockerPtr IsolateYield(IsolatePtr iso) {
+  return new m_unlocker(iso, UsageScope::Pause(iso));
+}
+
+void IsolateResume(UnlockerPtr ptr) {
+  UsageScope* paused = ptr->paused;
+  delete ptr;
+  UsageScope::Resume(paused);
+}
+
+ExecutionUsage IsolateGetExecutionUsage(IsolatePtr iso) {
+  if (iso == nullptr) {
+    return ExecutionUsage{0};
+  }
+  return isolateInternalContext(iso)->usage.Load();
+}
+
 int IsolateIsExecutionTerminating(IsolatePtr iso) {
   return iso->IsExecutionTerminating();
 }
@@ -199,6 +1347,7 @@ IsolateHStatistics IsolationGetHeapStatistics(IsolatePtr iso) {
   }
   v8::HeapStatistics hs;
   iso->GetHeapStatistics(&hs);
+  IsolateAllocator* allocator = isolateAllocator(iso);
 
   return IsolateHStatistics{hs.total_heap_size(),
                             hs.total_heap_size_executable(),
@@ -210,7 +1359,176 @@ IsolateHStatistics IsolationGetHeapStatistics(IsolatePtr iso) {
                             hs.external_memory(),
                             hs.peak_malloced_memory(),
                             hs.number_of_native_contexts(),
-                            hs.number_of_detached_contexts()};
+                            hs.number_of_detached_contexts(),
+                            allocator->allocated(),
+                            allocator->peak(),
+                            allocator->pooled(),
+                            allocator->failed()};
+}
+
+int IsolateNumberOfHeapSpaces(IsolatePtr iso) {
+  if (iso == nullptr) {
+    return 0;
+  }
+  return iso->NumberOfHeapSpaces();
+}
+
+HeapSpaceStats IsolateGetHeapSpaceStatistics(IsolatePtr iso, int index) {
+  HeapSpaceStatistics hs;
+  if (iso == nullptr || !iso->GetHeapSpaceStatistics(&hs, index)) {
+    return HeapSpaceStats{nullptr};
+  }
+  return HeapSpaceStats{hs.space_name(), hs.space_size(),
+                        hs.space_used_size(), hs.space_available_size(),
+                        hs.physical_space_size()};
+}
+
+// Unlike the other statistics, the code statistics walk the heap, so they wait
+// for the isolate to be free.
+HeapCodeStats IsolateGetHeapCodeStatistics(IsolatePtr iso) {
+  if (iso == nullptr) {
+    return HeapCodeStats{0};
+  }
+  Locker locker(iso);
+  Isolate::Scope isolate_scope(iso);
+  HeapCodeStatistics hs;
+  if (!iso->GetHeapCodeAndMetadataStatistics(&hs)) {
+    return HeapCodeStats{0};
+  }
+  return HeapCodeStats{hs.code_and_metadata_size(),
+                       hs.bytecode_and_metadata_size(),
+                       hs.external_script_source_size(),
+                       hs.cpu_profiler_metadata_size()};
+}
+
+int IsolateNumberOfTrackedHeapObjectTypes(IsolatePtr iso) {
+  if (iso == nullptr) {
+    return 0;
+  }
+  return iso->NumberOfTrackedHeapObjectTypes();
+}
+
+// IsolateGetHeapObjectStatistics returns 0 unless V8 runs with the
+// --track-gc-object-stats flag, as the statistics are gathered by the GC.
+int IsolateGetHeapObjectStatistics(IsolatePtr iso,
+                                   int index,
+                                   HeapObjectStats* stats) {
+  HeapObjectStatistics hs;
+  if (iso == nullptr || !iso->GetHeapObjectStatisticsAtLastGC(&hs, index)) {
+    return 0;
+  }
+  *stats = HeapObjectStats{hs.object_type(), hs.object_sub_type(),
+                           hs.object_count(), hs.object_size()};
+  return 1;
+}
+
+static inline m_gcRecorder* isolateGCRecorder(Isolate* iso) {
+  return static_cast<m_gcRecorder*>(iso->GetData(1));
+}
+
+static inline size_t usedHeapSize(Isolate* iso) {
+  v8::HeapStatistics hs;
+  iso->GetHeapStatistics(&hs);
+  return hs.used_heap_size();
+}
+
+static void GCPrologue(Isolate* iso,
+                       GCType type,
+                       GCCallbackFlags flags,
+                       void* data) {
+  m_gcRecorder* r = static_cast<m_gcRecorder*>(data);
+  int i = __builtin_ctz(type);
+  r->start[i] = clockNanos(CLOCK_REALTIME);
+  r->start_mono[i] = clockNanos(CLOCK_MONOTONIC);
+  r->used_before[i] = usedHeapSize(iso);
+}
+
+static void GCEpilogue(Isolate* iso,
+                       GCType type,
+                       GCCallbackFlags flags,
+                       void* data) {
+  m_gcRecorder* r = static_cast<m_gcRecorder*>(data);
+  int i = __builtin_ctz(type);
+  if (r->start_mono[i] == 0) {
+    // tracking started during this GC
+    return;
+  }
+  GCEvent event{type,
+                flags,
+                r->start[i],
+                clockNanos(CLOCK_MONOTONIC) - r->start_mono[i],
+                r->used_before[i],
+                usedHeapSize(iso)};
+  r->start_mono[i] = 0;
+
+  std::lock_guard<std::mutex> lock(r->mu);
+  GCStats& stats = r->stats[i];
+  stats.count++;
+  stats.total += event.duration;
+  if (event.duration > stats.max) {
+    stats.max = event.duration;
+  }
+  r->events[(r->head + r->count) % m_gcRecorder::kMaxEvents] = event;
+  if (r->count == m_gcRecorder::kMaxEvents) {
+    r->head = (r->head + 1) % m_gcRecorder::kMaxEvents;
+  } else {
+    r->count++;
+  }
+}
+
+void IsolateStartGCTracking(IsolatePtr iso) {
+  if (iso == nullptr) {
+    return;
+  }
+  Locker locker(iso);
+  if (isolateGCRecorder(iso) != nullptr) {
+    return;
+  }
+  m_gcRecorder* r = new m_gcRecorder;
+  iso->SetData(1, r);
+  iso->AddGCPrologueCallback(GCPrologue, r);
+  iso->AddGCEpilogueCallback(GCEpilogue, r);
+}
+
+void IsolateStopGCTracking(IsolatePtr iso) {
+  if (iso == nullptr) {
+    return;
+  }
+  Locker locker(iso);
+  m_gcRecorder* r = isolateGCRecorder(iso);
+  if (r == nullptr) {
+    return;
+  }
+  iso->RemoveGCPrologueCallback(GCPrologue, r);
+  iso->RemoveGCEpilogueCallback(GCEpilogue, r);
+  iso->SetData(1, nullptr);
+  delete r;
+}
+
+// The GC events and statistics are read without taking the isolate, which
+// may be collecting garbage in the meantime.
+int IsolateTakeGCEvents(IsolatePtr iso, GCEvent* events, int max) {
+  m_gcRecorder* r = isolateGCRecorder(iso);
+  if (r == nullptr) {
+    return 0;
+  }
+  std::lock_guard<std::mutex> lock(r->mu);
+  int n = std::min(max, r->count);
+  for (int i = 0; i < n; i++) {
+    events[i] = r->events[(r->head + i) % m_gcRecorder::kMaxEvents];
+  }
+  r->head = (r->head + n) % m_gcRecorder::kMaxEvents;
+  r->count -= n;
+  return n;
+}
+
+GCStats IsolateGetGCStatistics(IsolatePtr iso, int type) {
+  m_gcRecorder* r = isolateGCRecorder(iso);
+  if (r == nullptr) {
+    return GCStats{0};
+  }
+  std::lock_guard<std::mutex> lock(r->mu);
+  return r->stats[__builtin_ctz(type)];
 }
 
 RtnUnboundScript IsolateCompileUnboundScript(IsolatePtr iso,
@@ -234,9 +1552,12 @@ RtnUnboundScript IsolateCompileUnboundScript(IsolatePtr iso,
 
   ScriptCompiler::CachedData* cached_data = nullptr;
 
+  // The data is only read during compilation, so it is used in place whether
+  // it is Go, C or memory mapped; the Source only frees the CachedData itself.
   if (opts.cachedData.data) {
-    cached_data = new ScriptCompiler::CachedData(opts.cachedData.data,
-                                                 opts.cachedData.length);
+    cached_data = new ScriptCompiler::CachedData(
+        opts.cachedData.data, opts.cachedData.length,
+        ScriptCompiler::CachedData::BufferNotOwned);
   }
 
   ScriptOrigin script_origin(iso, ogn);
@@ -260,6 +1581,168 @@ RtnUnboundScript IsolateCompileUnboundScript(IsolatePtr iso,
   return rtn;
 }
 
+// SourceStream hands the whole source to the streaming compiler as a single
+// chunk, which V8 takes ownership of.
+class SourceStream : public ScriptCompiler::ExternalSourceStream {
+ public:
+  SourceStream(uint8_t* data, size_t length) : data_(data), length_(length) {}
+  ~SourceStream() override { delete[] data_; }
+
+  size_t GetMoreData(const uint8_t** src) override {
+    if (data_ == nullptr || length_ == 0) {
+      return 0;
+    }
+    *src = data_;
+    data_ = nullptr;
+    return length_;
+  }
+
+ private:
+  uint8_t* data_;
+  size_t length_;
+};
+
+// ReaderSourceStream reads the source from a Go io.Reader in chunks, keeping a
+// copy of it as the full source is needed to create the script.
+class ReaderSourceStream : public ScriptCompiler::ExternalSourceStream {
+ public:
+  ReaderSourceStream(int reader_ref, std::string* source)
+      : reader_ref_(reader_ref), source_(source) {}
+
+  size_t GetMoreData(const uint8_t** src) override {
+    uint8_t* chunk = new uint8_t[kChunkSize];
+    int n = goReadSource(reader_ref_, chunk, kChunkSize);
+    if (n <= 0) {
+      delete[] chunk;
+      return 0;
+    }
+    source_->append(reinterpret_cast<char*>(chunk), n);
+    *src = chunk;
+    return n;
+  }
+
+ private:
+  static const int kChunkSize = 64 << 10;
+
+  int reader_ref_;
+  std::string* source_;
+};
+
+// SourceResource hands a buffered ASCII source to V8 as an external string,
+// rather than copying it onto the heap.
+class SourceResource : public String::ExternalOneByteStringResource {
+ public:
+  explicit SourceResource(std::string source) : source_(std::move(source)) {}
+  const char* data() const override { return source_.data(); }
+  size_t length() const override { return source_.size(); }
+
+ private:
+  std::string source_;
+};
+
+struct m_streamingCompile {
+  Global<String> source;
+  ScriptCompiler::StreamedSource streamed;
+  std::unique_ptr<ScriptCompiler::ScriptStreamingTask> task;
+  std::unique_ptr<std::string> buffered;
+};
+
+static MaybeLocal<String> BufferedSource(Isolate* iso, std::string& source) {
+  for (char c : source) {
+    if (static_cast<unsigned char>(c) >= 0x80) {
+      return String::NewFromUtf8(iso, source.data(), NewStringType::kNormal,
+                                 source.size());
+    }
+  }
+  return String::NewExternalOneByte(iso,
+                                    new SourceResource(std::move(source)));
+}
+
+// IsolateStartStreamingCompile prepares the compilation of a script by
+// StreamingCompileRun, which does the parsing and compiling without the
+// isolate and may run on any thread, after which StreamingCompileFinish
+// creates the script in the isolate and frees the compilation.
+StreamingCompilePtr IsolateStartStreamingCompile(IsolatePtr iso,
+                                                 const char* s,
+                                                 int len) {
+  ISOLATE_SCOPE(iso);
+
+  Local<String> src =
+      String::NewFromUtf8(iso, s, NewStringType::kNormal, len)
+          .ToLocalChecked();
+  uint8_t* chunk = new uint8_t[len];
+  memcpy(chunk, s, len);
+
+  m_streamingCompile* sc = new m_streamingCompile{
+      Global<String>(iso, src),
+      ScriptCompiler::StreamedSource(std::make_unique<SourceStream>(chunk, len),
+                                     ScriptCompiler::StreamedSource::UTF8),
+      nullptr, nullptr};
+  sc->task.reset(ScriptCompiler::StartStreaming(iso, &sc->streamed));
+  return sc;
+}
+
+// IsolateStartStreamingCompileReader is like IsolateStartStreamingCompile, but
+// StreamingCompileRun reads the source from the Go reader registered as
+// reader_ref.
+StreamingCompilePtr IsolateStartStreamingCompileReader(IsolatePtr iso,
+                                                       int reader_ref) {
+  ISOLATE_SCOPE(iso);
+
+  std::unique_ptr<std::string> buffered = std::make_unique<std::string>();
+  std::unique_ptr<ReaderSourceStream> stream =
+      std::make_unique<ReaderSourceStream>(reader_ref, buffered.get());
+  m_streamingCompile* sc = new m_streamingCompile{
+      Global<String>(),
+      ScriptCompiler::StreamedSource(std::move(stream),
+                                     ScriptCompiler::StreamedSource::UTF8),
+      nullptr, std::move(buffered)};
+  sc->task.reset(ScriptCompiler::StartStreaming(iso, &sc->streamed));
+  return sc;
+}
+
+void StreamingCompileRun(StreamingCompilePtr ptr) {
+  ptr->task->Run();
+}
+
+RtnUnboundScript StreamingCompileFinish(IsolatePtr iso,
+                                        StreamingCompilePtr ptr,
+                                        const char* o) {
+  ISOLATE_SCOPE_INTERNAL_CONTEXT(iso);
+  std::unique_ptr<m_streamingCompile> sc(ptr);
+  TryCatch try_catch(iso);
+  Local<Context> local_ctx = ctx->ptr.Get(iso);
+  Context::Scope context_scope(local_ctx);
+
+  RtnUnboundScript rtn = {};
+
+  Local<String> src;
+  if (sc->buffered) {
+    if (!BufferedSource(iso, *sc->buffered).ToLocal(&src)) {
+      rtn.error.msg = CopyString("RangeError: Invalid string length");
+      return rtn;
+    }
+  } else {
+    src = sc->source.Get(iso);
+    sc->source.Reset();
+  }
+  Local<String> ogn =
+      String::NewFromUtf8(iso, o, NewStringType::kNormal).ToLocalChecked();
+  ScriptOrigin script_origin(iso, ogn);
+
+  Local<Script> script;
+  if (!ScriptCompiler::Compile(local_ctx, &sc->streamed, src, script_origin)
+           .ToLocal(&script)) {
+    rtn.error = ExceptionError(try_catch, iso, local_ctx);
+    return rtn;
+  }
+
+  m_unboundScript* us = new m_unboundScript;
+  us->ptr.Reset(iso, script->GetUnboundScript());
+  rtn.ptr = tracked_unbound_script(ctx, us);
+  return rtn;
+}
+
 /********** Exceptions & Errors **********/
 
 ValuePtr IsolateThrowException(IsolatePtr iso, ValuePtr value) {
@@ -365,28 +1848,123 @@ CPUProfile* CPUProfilerStopProfiling(CPUProfiler* profiler, const char* title) {
   profile->startTime = profile->ptr->GetStartTime();
   profile->endTime = profile->ptr->GetEndTime();
 
-  return profile;
+  return profile;
+}
+
+void CPUProfileNodeDelete(CPUProfileNode* node) {
+  for (int i = 0; i < node->childrenCount; ++i) {
+    CPUProfileNodeDelete(node->children[i]);
+  }
+
+  delete[] node->children;
+  delete node;
+}
+
+void CPUProfileDelete(CPUProfile* profile) {
+  if (profile->ptr == nullptr) {
+    return;
+  }
+  profile->ptr->Delete();
+  free((void*)profile->title);
+
+  CPUProfileNodeDelete(profile->root);
+
+  delete profile;
+}
+
+/********** Heap Profiler **********/
+
+// SnapshotOutputStream hands each chunk of a serialized heap snapshot to the
+// Go writer registered as writer_ref, without buffering the snapshot.
+class SnapshotOutputStream : public OutputStream {
+ public:
+  explicit SnapshotOutputStream(int writer_ref) : writer_ref_(writer_ref) {}
+
+  void EndOfStream() override {}
+
+  int GetChunkSize() override { return kChunkSize; }
+
+  WriteResult WriteAsciiChunk(char* data, int size) override {
+    if (!goWriteHeapSnapshot(writer_ref_, data, size)) {
+      return kAbort;
+    }
+    return kContinue;
+  }
+
+ private:
+  static const int kChunkSize = 64 << 10;
+
+  int writer_ref_;
+};
+
+void HeapProfilerTakeSnapshot(IsolatePtr iso, int writer_ref) {
+  ISOLATE_SCOPE(iso);
+  const HeapSnapshot* snapshot = iso->GetHeapProfiler()->TakeHeapSnapshot();
+  SnapshotOutputStream stream(writer_ref);
+  snapshot->Serialize(&stream, HeapSnapshot::kJSON);
+  const_cast<HeapSnapshot*>(snapshot)->Delete();
+}
+
+int HeapProfilerStartSampling(IsolatePtr iso, uint64_t interval, int depth) {
+  ISOLATE_SCOPE(iso);
+  return iso->GetHeapProfiler()->StartSamplingHeapProfiler(interval, depth);
 }
 
-void CPUProfileNodeDelete(CPUProfileNode* node) {
-  for (int i = 0; i < node->childrenCount; ++i) {
-    CPUProfileNodeDelete(node->children[i]);
+void HeapProfilerStopSampling(IsolatePtr iso) {
+  ISOLATE_SCOPE(iso);
+  iso->GetHeapProfiler()->StopSamplingHeapProfiler();
+}
+
+static HeapProfileNode* NewHeapProfileNode(Isolate* iso,
+                                           AllocationProfile::Node* ptr_) {
+  int count = ptr_->children.size();
+  HeapProfileNode** children = new HeapProfileNode*[count];
+  for (int i = 0; i < count; ++i) {
+    children[i] = NewHeapProfileNode(iso, ptr_->children[i]);
   }
 
-  delete[] node->children;
-  delete node;
+  size_t self_size = 0;
+  size_t allocation_count = 0;
+  for (const AllocationProfile::Allocation& a : ptr_->allocations) {
+    self_size += a.size * a.count;
+    allocation_count += a.count;
+  }
+
+  String::Utf8Value name(iso, ptr_->name);
+  String::Utf8Value script_name(iso, ptr_->script_name);
+  HeapProfileNode* node = new HeapProfileNode{
+      CopyString(name),
+      CopyString(script_name),
+      ptr_->script_id,
+      ptr_->line_number,
+      ptr_->column_number,
+      self_size,
+      allocation_count,
+      count,
+      children,
+  };
+  return node;
 }
 
-void CPUProfileDelete(CPUProfile* profile) {
-  if (profile->ptr == nullptr) {
-    return;
+HeapProfileNode* HeapProfilerGetAllocationProfile(IsolatePtr iso) {
+  ISOLATE_SCOPE(iso);
+  std::unique_ptr<AllocationProfile> profile(
+      iso->GetHeapProfiler()->GetAllocationProfile());
+  if (!profile) {
+    return nullptr;
   }
-  profile->ptr->Delete();
-  free((void*)profile->title);
+  return NewHeapProfileNode(iso, profile->GetRootNode());
+}
 
-  CPUProfileNodeDelete(profile->root);
+void HeapProfileNodeDelete(HeapProfileNode* node) {
+  for (int i = 0; i < node->childrenCount; ++i) {
+    HeapProfileNodeDelete(node->children[i]);
+  }
 
-  delete profile;
+  free((void*)node->functionName);
+  free((void*)node->scriptResourceName);
+  delete[] node->children;
+  delete node;
 }
 
 /********** Template **********/
@@ -478,6 +2056,14 @@ int ObjectTemplateInternalFieldCount(TemplatePtr ptr) {
 
 /********** FunctionTemplate **********/
 
+// ContextClosedError is the Error of a callback called in a context that was
+// closed on the Go side, for example from a function it left behind.
+static Local<Value> ContextClosedError(Isolate* iso, const char* what) {
+  std::string msg = std::string(what) + ": the context is closed";
+  return Exception::Error(
+      String::NewFromUtf8(iso, msg.c_str()).ToLocalChecked());
+}
+
 static void FunctionTemplateCallback(const FunctionCallbackInfo<Value>& info) {
   Isolate* iso = info.GetIsolate();
   ISOLATE_SCOPE(iso);
@@ -488,6 +2074,10 @@ static void FunctionTemplateCallback(const FunctionCallbackInfo<Value>& info) {
   Local<Context> local_ctx = iso->GetCurrentContext();
   int ctx_ref = local_ctx->GetEmbedderData(1).As<Integer>()->Value();
   m_ctx* ctx = goContext(ctx_ref);
+  if (ctx == nullptr) {
+    iso->ThrowException(ContextClosedError(iso, "Cannot call function"));
+    return;
+  }
 
   int callback_ref = info.Data().As<Integer>()->Value();
 
@@ -512,8 +2102,11 @@ static void FunctionTemplateCallback(const FunctionCallbackInfo<Value>& info) {
     args[i] = tracked_value(ctx, val);
   }
 
-  ValuePtr val =
-      goFunctionCallback(ctx_ref, callback_ref, thisAndArgs, args_count);
+  ValuePtr val;
+  {
+    CallbackScope callback_scope(iso, ctx);
+    val = goFunctionCallback(ctx_ref, callback_ref, thisAndArgs, args_count);
+  }
   if (val != nullptr) {
     info.GetReturnValue().Set(val->ptr.Get(iso));
   } else {
@@ -575,7 +2168,8 @@ RtnValue FunctionTemplateGetFunction(TemplatePtr ptr, ContextPtr ctx) {
 
 ContextPtr NewContext(IsolatePtr iso,
                       TemplatePtr global_template_ptr,
-                      int ref) {
+                      int ref,
+                      int microtasks_policy) {
   Locker locker(iso);
   Isolate::Scope isolate_scope(iso);
   HandleScope handle_scope(iso);
@@ -592,24 +2186,81 @@ ContextPtr NewContext(IsolatePtr iso,
   // context as a simple integer identifier; this can then be used on the Go
   // side to lookup the context in the context registry. We use slot 1 as slot 0
   // has special meaning for the Chrome debugger.
-  Local<Context> local_ctx = Context::New(iso, nullptr, global_template);
+  // A negative policy uses the default microtask queue of the isolate.
+  std::unique_ptr<MicrotaskQueue> microtask_queue;
+  if (microtasks_policy >= 0) {
+    microtask_queue = MicrotaskQueue::New(
+        iso, static_cast<MicrotasksPolicy>(microtasks_policy));
+  }
+  Local<Context> local_ctx =
+      Context::New(iso, nullptr, global_template, MaybeLocal<Value>(),
+                   DeserializeInternalFieldsCallback(), microtask_queue.get());
   local_ctx->SetEmbedderData(1, Integer::New(iso, ref));
 
   m_ctx* ctx = new m_ctx;
+  ctx->microtask_queue = std::move(microtask_queue);
   ctx->ptr.Reset(iso, local_ctx);
   ctx->iso = iso;
   return ctx;
 }
 
+ExecutionUsage ContextGetExecutionUsage(ContextPtr ctx) {
+  if (ctx == nullptr) {
+    return ExecutionUsage{0};
+  }
+  return ctx->usage.Load();
+}
+
 int ContextRetainedValueCount(ContextPtr ctx) {
   return ctx->vals.size();
 }
 
+static void FreeClosedMicrotaskQueue(
+    const WeakCallbackInfo<m_closedMicrotaskQueue>& info) {
+  m_closedMicrotaskQueue* closed = info.GetParameter();
+  closed->internal_ctx->closed_microtask_queues.erase(closed);
+  delete closed;
+}
+
+static void ClosedContextCollected(
+    const WeakCallbackInfo<m_closedMicrotaskQueue>& info) {
+  info.GetParameter()->ptr.Reset();
+  // deleting the queue touches the isolate, which the first pass must not do
+  info.SetSecondPassCallback(FreeClosedMicrotaskQueue);
+}
+
+// ContextCloseMicrotaskQueue drops the pending tasks of the queue of a closed
+// context, which would keep its native context alive, and hands the queue over
+// to the internal context until the native context is collected.
+static void ContextCloseMicrotaskQueue(m_ctx* ctx, m_ctx* internal_ctx) {
+  Isolate* iso = ctx->iso;
+  Locker locker(iso);
+  Isolate::Scope isolate_scope(iso);
+  HandleScope handle_scope(iso);
+
+  // the queue throws its tasks away when a checkpoint is terminated; this
+  // cannot be done while JavaScript is running, which the termination would
+  // stop, so the tasks are left to the next checkpoint of the queue then
+  if (!iso->InContext()) {
+    TryCatch try_catch(iso);
+    iso->TerminateExecution();
+    ctx->microtask_queue->PerformCheckpoint(iso);
+    iso->CancelTerminateExecution();
+  }
+
+  m_closedMicrotaskQueue* closed = new m_closedMicrotaskQueue;
+  closed->internal_ctx = internal_ctx;
+  closed->ptr.Reset(iso, ctx->ptr.Get(iso));
+  closed->ptr.SetWeak(closed, ClosedContextCollected,
+                      WeakCallbackType::kParameter);
+  closed->queue = std::move(ctx->microtask_queue);
+  internal_ctx->closed_microtask_queues.insert(closed);
+}
+
 void ContextFree(ContextPtr ctx) {
   if (ctx == nullptr) {
     return;
   }
-  ctx->ptr.Reset();
 
   for (auto it = ctx->vals.begin(); it != ctx->vals.end(); ++it) {
     auto value = it->second;
@@ -623,11 +2274,47 @@ void ContextFree(ContextPtr ctx) {
     delete us;
   }
 
+  for (auto it = ctx->modules.begin(); it != ctx->modules.end(); ++it) {
+    it->second->ptr.Reset();
+    delete it->second;
+  }
+
+  m_ctx* internal_ctx = isolateInternalContext(ctx->iso);
+  if (ctx != internal_ctx && ctx->microtask_queue) {
+    ContextCloseMicrotaskQueue(ctx, internal_ctx);
+  } else if (ctx == internal_ctx) {
+    // the queues are unlinked from the isolate as they are deleted
+    Locker locker(ctx->iso);
+    Isolate::Scope isolate_scope(ctx->iso);
+    // a queue whose native context was collected may be waiting for its second
+    // pass, which only a forced collection runs right away
+    for (m_closedMicrotaskQueue* closed : ctx->closed_microtask_queues) {
+      if (closed->ptr.IsEmpty()) {
+        ctx->iso->LowMemoryNotification();
+        break;
+      }
+    }
+    for (m_closedMicrotaskQueue* closed : ctx->closed_microtask_queues) {
+      closed->ptr.Reset();
+      delete closed;
+    }
+    ctx->closed_microtask_queues.clear();
+    ctx->microtask_queue.reset();
+  }
+
+  ctx->ptr.Reset();
   delete ctx;
 }
 
+void ContextPerformMicrotaskCheckpoint(ContextPtr ctx) {
+  LOCAL_CONTEXT(ctx);
+  UsageScope usage_scope(iso, ctx);
+  local_ctx->GetMicrotaskQueue()->PerformCheckpoint(iso);
+}
+
 RtnValue RunScript(ContextPtr ctx, const char* source, const char* origin) {
   LOCAL_CONTEXT(ctx);
+  UsageScope usage_scope(iso, ctx);
 
   RtnValue rtn = {};
 
@@ -682,6 +2369,17 @@ ScriptCompilerCachedData* UnboundScriptCreateCodeCache(
   return cd;
 }
 
+// UnboundScriptRelease frees a script compiled in the isolate before the
+// isolate is disposed, which otherwise keeps it alive until then.
+void UnboundScriptRelease(IsolatePtr iso, UnboundScriptPtr us_ptr) {
+  ISOLATE_SCOPE_INTERNAL_CONTEXT(iso);
+  if (ctx->unboundScripts.erase(us_ptr) == 0) {
+    return;
+  }
+  us_ptr->ptr.Reset();
+  delete us_ptr;
+}
+
 void ScriptCompilerCachedDataDelete(ScriptCompilerCachedData* cached_data) {
   delete cached_data->ptr;
   delete cached_data;
@@ -691,6 +2389,7 @@ void ScriptCompilerCachedDataDelete(ScriptCompilerCachedData* cached_data) {
 // the script was compiled in
 RtnValue UnboundScriptRun(ContextPtr ctx, UnboundScriptPtr us_ptr) {
   LOCAL_CONTEXT(ctx)
+  UsageScope usage_scope(iso, ctx);
 
   RtnValue rtn = {};
 
@@ -730,68 +2429,365 @@ RtnValue JSONParse(ContextPtr ctx, const char* str) {
   val->id = 0;
   val->iso = iso;
   val->ctx = ctx;
-  val->ptr = Persistent<Value, CopyablePersistentTraits<Value>>(iso, result);
-
-  rtn.value = tracked_value(ctx, val);
-  return rtn;
+  val->ptr = Persistent<Value, CopyablePersistentTraits<Value>>(iso, result);
+
+  rtn.value = tracked_value(ctx, val);
+  return rtn;
+}
+
+const char* JSONStringify(ContextPtr ctx, ValuePtr val) {
+  Isolate* iso;
+  Local<Context> local_ctx;
+
+  if (ctx != nullptr) {
+    iso = ctx->iso;
+  } else {
+    iso = val->iso;
+  }
+
+  Locker locker(iso);
+  Isolate::Scope isolate_scope(iso);
+  HandleScope handle_scope(iso);
+
+  if (ctx != nullptr) {
+    local_ctx = ctx->ptr.Get(iso);
+  } else {
+    if (val->ctx != nullptr) {
+      local_ctx = val->ctx->ptr.Get(iso);
+    } else {
+      m_ctx* ctx = isolateInternalContext(iso);
+      local_ctx = ctx->ptr.Get(iso);
+    }
+  }
+
+  Context::Scope context_scope(local_ctx);
+
+  Local<String> str;
+  if (!JSON::Stringify(local_ctx, val->ptr.Get(iso)).ToLocal(&str)) {
+    return nullptr;
+  }
+  String::Utf8Value json(iso, str);
+  return CopyString(json);
+}
+
+void ValueRelease(ValuePtr ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+
+  ptr->ctx->vals.erase(ptr->id);
+  ptr->ptr.Reset();
+  delete ptr;
+}
+
+ValuePtr ContextGlobal(ContextPtr ctx) {
+  LOCAL_CONTEXT(ctx);
+  m_value* val = new m_value;
+  val->id = 0;
+
+  val->iso = iso;
+  val->ctx = ctx;
+  val->ptr = Persistent<Value, CopyablePersistentTraits<Value>>(
+      iso, local_ctx->Global());
+
+  return tracked_value(ctx, val);
+}
+
+/********** Module **********/
+
+// Modules are tracked by their context under their identity hash, so that the
+// m_module of a referrer can be found when resolving its imports.
+static m_module* findModule(m_ctx* ctx, Isolate* iso, Local<Module> module) {
+  auto range = ctx->modules.equal_range(module->GetIdentityHash());
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second->ptr.Get(iso) == module) {
+      return it->second;
+    }
+  }
+  return nullptr;
+}
+
+RtnModule CompileModule(ContextPtr ctx,
+                        const char* s,
+                        const char* o,
+                        CompileOptions opts) {
+  LOCAL_CONTEXT(ctx);
+  RtnModule rtn = {};
+
+  Local<String> src =
+      String::NewFromUtf8(iso, s, NewStringType::kNormal).ToLocalChecked();
+  Local<String> ogn =
+      String::NewFromUtf8(iso, o, NewStringType::kNormal).ToLocalChecked();
+  ScriptOrigin script_origin(iso, ogn, 0, 0, false, -1, Local<Value>(), false,
+                             false, true);
+
+  ScriptCompiler::CompileOptions option =
+      static_cast<ScriptCompiler::CompileOptions>(opts.compileOption);
+  ScriptCompiler::CachedData* cached_data = nullptr;
+  if (opts.cachedData.data) {
+    cached_data = new ScriptCompiler::CachedData(
+        opts.cachedData.data, opts.cachedData.length,
+        ScriptCompiler::CachedData::BufferNotOwned);
+  }
+  ScriptCompiler::Source source(src, script_origin, cached_data);
+
+  Local<Module> module;
+  if (!ScriptCompiler::CompileModule(iso, &source, option).ToLocal(&module)) {
+    rtn.error = ExceptionError(try_catch, iso, local_ctx);
+    return rtn;
+  }
+  if (cached_data) {
+    rtn.cachedDataRejected = cached_data->rejected;
+  }
+
+  m_module* m = new m_module;
+  m->ptr.Reset(iso, module);
+  ctx->modules.emplace(module->GetIdentityHash(), m);
+  rtn.ptr = m;
+  return rtn;
+}
+
+static MaybeLocal<Module> ResolveModuleCallback(
+    Local<Context> local_ctx,
+    Local<String> specifier,
+    Local<FixedArray> import_assertions,
+    Local<Module> referrer) {
+  Isolate* iso = local_ctx->GetIsolate();
+  int ctx_ref = local_ctx->GetEmbedderData(1).As<Integer>()->Value();
+  m_ctx* ctx = goContext(ctx_ref);
+  if (ctx == nullptr) {
+    iso->ThrowException(ContextClosedError(iso, "Cannot resolve module"));
+    return MaybeLocal<Module>();
+  }
+
+  String::Utf8Value spec(iso, specifier);
+  struct goResolveModule_return resolved;
+  {
+    CallbackScope callback_scope(iso, ctx);
+    resolved = goResolveModule(ctx_ref, *spec, findModule(ctx, iso, referrer));
+  }
+  if (resolved.r0 == nullptr) {
+    iso->ThrowException(Exception::Error(
+        String::NewFromUtf8(iso, resolved.r1).ToLocalChecked()));
+    free(resolved.r1);
+    return MaybeLocal<Module>();
+  }
+  return resolved.r0->ptr.Get(iso);
+}
+
+RtnError ModuleInstantiate(ContextPtr ctx, ModulePtr ptr) {
+  LOCAL_CONTEXT(ctx);
+  RtnError rtn = {};
+  Local<Module> module = ptr->ptr.Get(iso);
+  if (module->InstantiateModule(local_ctx, ResolveModuleCallback).IsNothing()) {
+    rtn = ExceptionError(try_catch, iso, local_ctx);
+  }
+  return rtn;
+}
+
+// ModuleEvaluate returns the promise of the evaluation, as modules may use
+// top-level await, unless evaluating failed synchronously.
+RtnValue ModuleEvaluate(ContextPtr ctx, ModulePtr ptr) {
+  LOCAL_CONTEXT(ctx);
+  UsageScope usage_scope(iso, ctx);
+  RtnValue rtn = {};
+  Local<Module> module = ptr->ptr.Get(iso);
+
+  Local<Value> result;
+  if (!module->Evaluate(local_ctx).ToLocal(&result)) {
+    rtn.error = ExceptionError(try_catch, iso, local_ctx);
+    return rtn;
+  }
+  if (result->IsPromise()) {
+    Local<Promise> promise = result.As<Promise>();
+    if (promise->State() == Promise::kRejected) {
+      rtn.error = RejectionError(try_catch, iso, local_ctx, promise);
+      return rtn;
+    }
+  }
+
+  m_value* val = new m_value;
+  val->id = 0;
+  val->iso = iso;
+  val->ctx = ctx;
+  val->ptr = Persistent<Value, CopyablePersistentTraits<Value>>(iso, result);
+  rtn.value = tracked_value(ctx, val);
+  return rtn;
+}
+
+ValuePtr ModuleGetNamespace(ContextPtr ctx, ModulePtr ptr) {
+  LOCAL_CONTEXT(ctx);
+  m_value* val = new m_value;
+  val->id = 0;
+  val->iso = iso;
+  val->ctx = ctx;
+  val->ptr = Persistent<Value, CopyablePersistentTraits<Value>>(
+      iso, ptr->ptr.Get(iso)->GetModuleNamespace());
+  return tracked_value(ctx, val);
+}
+
+int ModuleGetStatus(ContextPtr ctx, ModulePtr ptr) {
+  LOCAL_CONTEXT(ctx);
+  return ptr->ptr.Get(iso)->GetStatus();
+}
+
+int ModuleGetRequestsLength(ContextPtr ctx, ModulePtr ptr) {
+  LOCAL_CONTEXT(ctx);
+  return ptr->ptr.Get(iso)->GetModuleRequests()->Length();
+}
+
+const char* ModuleGetRequest(ContextPtr ctx, ModulePtr ptr, int i) {
+  LOCAL_CONTEXT(ctx);
+  Local<ModuleRequest> request = ptr->ptr.Get(iso)
+                                     ->GetModuleRequests()
+                                     ->Get(local_ctx, i)
+                                     .As<ModuleRequest>();
+  String::Utf8Value specifier(iso, request->GetSpecifier());
+  return CopyString(specifier);
+}
+
+ScriptCompilerCachedData* ModuleCreateCodeCache(ContextPtr ctx,
+                                                ModulePtr ptr) {
+  LOCAL_CONTEXT(ctx);
+  ScriptCompiler::CachedData* cached_data = ScriptCompiler::CreateCodeCache(
+      ptr->ptr.Get(iso)->GetUnboundModuleScript());
+
+  ScriptCompilerCachedData* cd = new ScriptCompilerCachedData;
+  cd->ptr = cached_data;
+  cd->data = cached_data->data;
+  cd->length = cached_data->length;
+  cd->rejected = cached_data->rejected;
+  return cd;
+}
+
+/********** Dynamic import **********/
+
+// An import() waits in the microtask queue of its context before its handler
+// is called, so that no module is loaded or evaluated from within the import()
+// expression itself. The pending import is a function holding the specifier,
+// referrer and resolver, rather than a struct of its own, so that the heap
+// frees it along with the queue if the context is closed before it runs.
+static void RunDynamicImport(const FunctionCallbackInfo<Value>& info) {
+  Isolate* iso = info.GetIsolate();
+  Local<Context> local_ctx = iso->GetCurrentContext();
+  int ctx_ref = local_ctx->GetEmbedderData(1).As<Integer>()->Value();
+  m_ctx* ctx = goContext(ctx_ref);
+  if (ctx == nullptr) {
+    // the context was closed before the import could run
+    return;
+  }
+  Local<Array> data = info.Data().As<Array>();
+  String::Utf8Value spec(iso, data->Get(local_ctx, 0).ToLocalChecked());
+  String::Utf8Value referrer(iso, data->Get(local_ctx, 1).ToLocalChecked());
+
+  m_value* val = new m_value;
+  val->id = 0;
+  val->iso = iso;
+  val->ctx = ctx;
+  val->ptr = Persistent<Value, CopyablePersistentTraits<Value>>(
+      iso, data->Get(local_ctx, 2).ToLocalChecked());
+  CallbackScope callback_scope(iso, ctx);
+  goDynamicImport(ctx_ref, *spec, *referrer ? *referrer : const_cast<char*>(""),
+                  tracked_value(ctx, val));
+}
+
+static MaybeLocal<Promise> DynamicImportCallback(
+    Local<Context> local_ctx,
+    Local<Data> host_defined_options,
+    Local<Value> resource_name,
+    Local<String> specifier,
+    Local<FixedArray> import_assertions) {
+  Isolate* iso = local_ctx->GetIsolate();
+  Local<Promise::Resolver> resolver;
+  if (!Promise::Resolver::New(local_ctx).ToLocal(&resolver)) {
+    return MaybeLocal<Promise>();
+  }
+  int ctx_ref = local_ctx->GetEmbedderData(1).As<Integer>()->Value();
+  if (goContext(ctx_ref) == nullptr) {
+    resolver->Reject(local_ctx, ContextClosedError(iso, "Cannot import module"))
+        .Check();
+    return resolver->GetPromise();
+  }
+
+  Local<Value> data[] = {specifier, resource_name, resolver};
+  Local<Function> run;
+  if (!Function::New(local_ctx, RunDynamicImport,
+                     Array::New(iso, data, 3))
+           .ToLocal(&run)) {
+    return MaybeLocal<Promise>();
+  }
+  local_ctx->GetMicrotaskQueue()->EnqueueMicrotask(iso, run);
+  return resolver->GetPromise();
+}
+
+static void ImportMetaCallback(Local<Context> local_ctx,
+                               Local<Module> module,
+                               Local<Object> meta) {
+  Isolate* iso = local_ctx->GetIsolate();
+  int ctx_ref = local_ctx->GetEmbedderData(1).As<Integer>()->Value();
+  m_ctx* ctx = goContext(ctx_ref);
+  if (ctx == nullptr) {
+    // V8 does not expect the hook to throw, so import.meta is left empty
+    return;
+  }
+
+  m_value* val = new m_value;
+  val->id = 0;
+  val->iso = iso;
+  val->ctx = ctx;
+  val->ptr = Persistent<Value, CopyablePersistentTraits<Value>>(iso, meta);
+  CallbackScope callback_scope(iso, ctx);
+  goImportMeta(ctx_ref, findModule(ctx, iso, module), tracked_value(ctx, val));
 }
 
-const char* JSONStringify(ContextPtr ctx, ValuePtr val) {
-  Isolate* iso;
-  Local<Context> local_ctx;
-
-  if (ctx != nullptr) {
-    iso = ctx->iso;
-  } else {
-    iso = val->iso;
-  }
-
-  Locker locker(iso);
-  Isolate::Scope isolate_scope(iso);
-  HandleScope handle_scope(iso);
+static void ReturnData(const FunctionCallbackInfo<Value>& info) {
+  info.GetReturnValue().Set(info.Data());
+}
 
-  if (ctx != nullptr) {
-    local_ctx = ctx->ptr.Get(iso);
-  } else {
-    if (val->ctx != nullptr) {
-      local_ctx = val->ctx->ptr.Get(iso);
-    } else {
-      m_ctx* ctx = isolateInternalContext(iso);
-      local_ctx = ctx->ptr.Get(iso);
-    }
+static void RejectWithException(Local<Context> local_ctx,
+                                Local<Promise::Resolver> resolver,
+                                TryCatch& try_catch) {
+  if (try_catch.HasCaught() && !try_catch.HasTerminated()) {
+    resolver->Reject(local_ctx, try_catch.Exception()).Check();
   }
+}
 
-  Context::Scope context_scope(local_ctx);
+// DynamicImportResolve instantiates and evaluates the module, then resolves
+// the promise of the import() with its namespace once the evaluation, which
+// may be pending on top-level await, has completed. Errors reject the promise.
+void DynamicImportResolve(ContextPtr ctx, ValuePtr resolver_ptr, ModulePtr ptr) {
+  LOCAL_CONTEXT(ctx);
+  UsageScope usage_scope(iso, ctx);
+  Local<Promise::Resolver> resolver =
+      resolver_ptr->ptr.Get(iso).As<Promise::Resolver>();
+  Local<Module> module = ptr->ptr.Get(iso);
 
-  Local<String> str;
-  if (!JSON::Stringify(local_ctx, val->ptr.Get(iso)).ToLocal(&str)) {
-    return nullptr;
+  Local<Value> result;
+  if (module->InstantiateModule(local_ctx, ResolveModuleCallback).IsNothing() ||
+      !module->Evaluate(local_ctx).ToLocal(&result)) {
+    RejectWithException(local_ctx, resolver, try_catch);
+    return;
   }
-  String::Utf8Value json(iso, str);
-  return CopyString(json);
-}
-
-void ValueRelease(ValuePtr ptr) {
-  if (ptr == nullptr) {
+  Local<Function> get_namespace;
+  Local<Promise> namespace_promise;
+  if (!Function::New(local_ctx, ReturnData, module->GetModuleNamespace())
+           .ToLocal(&get_namespace) ||
+      !result.As<Promise>()
+           ->Then(local_ctx, get_namespace)
+           .ToLocal(&namespace_promise)) {
+    RejectWithException(local_ctx, resolver, try_catch);
     return;
   }
-
-  ptr->ctx->vals.erase(ptr->id);
-  ptr->ptr.Reset();
-  delete ptr;
+  resolver->Resolve(local_ctx, namespace_promise).Check();
 }
 
-ValuePtr ContextGlobal(ContextPtr ctx) {
+void DynamicImportReject(ContextPtr ctx, ValuePtr resolver_ptr, const char* msg) {
   LOCAL_CONTEXT(ctx);
-  m_value* val = new m_value;
-  val->id = 0;
-
-  val->iso = iso;
-  val->ctx = ctx;
-  val->ptr = Persistent<Value, CopyablePersistentTraits<Value>>(
-      iso, local_ctx->Global());
-
-  return tracked_value(ctx, val);
+  Local<Promise::Resolver> resolver =
+      resolver_ptr->ptr.Get(iso).As<Promise::Resolver>();
+  Local<Value> exception = Exception::Error(
+      String::NewFromUtf8(iso, msg, NewStringType::kNormal).ToLocalChecked());
+  resolver->Reject(local_ctx, exception).Check();
 }
 
 /********** Value **********/
@@ -1445,6 +3441,133 @@ int ObjectDeleteIdx(ValuePtr ptr, uint32_t idx) {
   return obj->Delete(local_ctx, idx).ToChecked();
 }
 
+/********** ArrayBuffer **********/
+
+// NewArrayBuffer allocates a buffer through the isolate's allocator, copying
+// data into it if given. External memory cannot be wrapped with
+// ArrayBuffer::NewBackingStore as the sandbox requires every backing store to
+// live inside its address space.
+RtnValue NewArrayBuffer(ContextPtr ctx, const void* data, size_t byte_length) {
+  LOCAL_CONTEXT(ctx);
+  RtnValue rtn = {};
+
+  // ArrayBuffer::New treats a failed allocation as out of memory
+  if (!isolateAllocator(iso)->CanAllocate(byte_length)) {
+    rtn.error.msg = CopyString("RangeError: Array buffer allocation failed");
+    return rtn;
+  }
+  Local<ArrayBuffer> buf = ArrayBuffer::New(iso, byte_length);
+  if (data != nullptr && byte_length > 0) {
+    memcpy(buf->Data(), data, byte_length);
+  }
+
+  m_value* val = new m_value;
+  val->id = 0;
+  val->iso = iso;
+  val->ctx = ctx;
+  val->ptr = Persistent<Value, CopyablePersistentTraits<Value>>(iso, buf);
+  rtn.value = tracked_value(ctx, val);
+  return rtn;
+}
+
+size_t ArrayBufferByteLength(ValuePtr ptr) {
+  LOCAL_VALUE(ptr);
+  return value.As<ArrayBuffer>()->ByteLength();
+}
+
+ValuePtr ArrayBufferViewBuffer(ValuePtr ptr) {
+  LOCAL_VALUE(ptr);
+  m_value* new_val = new m_value;
+  new_val->id = 0;
+  new_val->iso = iso;
+  new_val->ctx = ctx;
+  new_val->ptr = Persistent<Value, CopyablePersistentTraits<Value>>(
+      iso, value.As<ArrayBufferView>()->Buffer());
+  return tracked_value(ctx, new_val);
+}
+
+size_t ArrayBufferViewByteOffset(ValuePtr ptr) {
+  LOCAL_VALUE(ptr);
+  return value.As<ArrayBufferView>()->ByteOffset();
+}
+
+size_t ArrayBufferViewByteLength(ValuePtr ptr) {
+  LOCAL_VALUE(ptr);
+  return value.As<ArrayBufferView>()->ByteLength();
+}
+
+// ValueGetBackingStore returns the memory of an ArrayBuffer, or the part of it
+// covered by an ArrayBufferView, together with a reference to its backing
+// store that keeps the memory alive until BackingStoreRelease, even if the
+// buffer is garbage collected or detached in the meantime.
+RtnBackingStore ValueGetBackingStore(ValuePtr ptr) {
+  LOCAL_VALUE(ptr);
+  RtnBackingStore rtn = {};
+
+  std::shared_ptr<BackingStore> store;
+  size_t offset = 0;
+  size_t length;
+  if (value->IsArrayBufferView()) {
+    Local<ArrayBufferView> view = value.As<ArrayBufferView>();
+    store = view->Buffer()->GetBackingStore();
+    offset = view->ByteOffset();
+    length = view->ByteLength();
+  } else if (value->IsSharedArrayBuffer()) {
+    store = value.As<SharedArrayBuffer>()->GetBackingStore();
+    length = store->ByteLength();
+  } else {
+    store = value.As<ArrayBuffer>()->GetBackingStore();
+    length = store->ByteLength();
+  }
+  if (store->Data() != nullptr) {
+    rtn.data = static_cast<uint8_t*>(store->Data()) + offset;
+    rtn.byte_length = length;
+  }
+  rtn.ptr = new m_backingStore{std::move(store)};
+  return rtn;
+}
+
+void BackingStoreRelease(BackingStorePtr ptr) {
+  delete ptr;
+}
+
+/********** SharedArrayBuffer **********/
+
+static void SharedMemoryDeleter(void* data, size_t length, void*) {
+  default_allocator->Free(data, length);
+}
+
+// NewSharedMemory allocates memory for SharedArrayBuffers that is not tied to
+// any isolate. It comes from the default allocator, which places it inside the
+// sandbox as V8 requires, and is freed once the last SharedArrayBuffer and Go
+// reference to it are gone.
+RtnBackingStore NewSharedMemory(size_t byte_length) {
+  RtnBackingStore rtn = {};
+  void* data = default_allocator->Allocate(byte_length);
+  if (data == nullptr) {
+    return rtn;
+  }
+  std::shared_ptr<BackingStore> store = SharedArrayBuffer::NewBackingStore(
+      data, byte_length, SharedMemoryDeleter, nullptr);
+  rtn.data = data;
+  rtn.byte_length = byte_length;
+  rtn.ptr = new m_backingStore{std::move(store)};
+  return rtn;
+}
+
+RtnValue NewSharedArrayBuffer(ContextPtr ctx, BackingStorePtr store) {
+  LOCAL_CONTEXT(ctx);
+  RtnValue rtn = {};
+  Local<SharedArrayBuffer> buf = SharedArrayBuffer::New(iso, store->ptr);
+  m_value* val = new m_value;
+  val->id = 0;
+  val->iso = iso;
+  val->ctx = ctx;
+  val->ptr = Persistent<Value, CopyablePersistentTraits<Value>>(iso, buf);
+  rtn.value = tracked_value(ctx, val);
+  return rtn;
+}
+
 /********** Promise **********/
 
 RtnValue NewPromiseResolver(ContextPtr ctx) {
@@ -1495,32 +3618,6 @@ int PromiseState(ValuePtr ptr) {
   return promise->State();
 }
 
-RtnValue PromiseThen(ValuePtr ptr, int callback_ref) {
-  LOCAL_VALUE(ptr)
-  RtnValue rtn = {};
-  Local<Promise> promise = value.As<Promise>();
-  Local<Integer> cbData = Integer::New(iso, callback_ref);
-  Local<Function> func;
-  if (!Function::New(local_ctx, FunctionTemplateCallback, cbData)
-           .ToLocal(&func)) {
-    rtn.error = ExceptionError(try_catch, iso, local_ctx);
-    return rtn;
-  }
-  Local<Promise> result;
-  if (!promise->Then(local_ctx, func).ToLocal(&result)) {
-    rtn.error = ExceptionError(try_catch, iso, local_ctx);
-    return rtn;
-  }
-  m_value* result_val = new m_value;
-  result_val->id = 0;
-  result_val->iso = iso;
-  result_val->ctx = ctx;
-  result_val->ptr =
-      Persistent<Value, CopyablePersistentTraits<Value>>(iso, result);
-  rtn.value = tracked_value(ctx, result_val);
-  return rtn;
-}
-
 RtnValue PromiseThen2(ValuePtr ptr, int on_fulfilled_ref, int on_rejected_ref) {
   LOCAL_VALUE(ptr)
   RtnValue rtn = {};
@@ -1555,20 +3652,36 @@ RtnValue PromiseThen2(ValuePtr ptr, int on_fulfilled_ref, int on_rejected_ref) {
   return rtn;
 }
 
-RtnValue PromiseCatch(ValuePtr ptr, int callback_ref) {
+static void PromiseSettledCallback(const FunctionCallbackInfo<Value>& info) {
+  goPromiseSettled(info.Data().As<Integer>()->Value());
+}
+
+// PromiseAwait performs a microtask checkpoint, then returns the state of the
+// promise and, once it is settled, its result. When awaiter_ref is set and the
+// promise is still pending, a reaction notifying the awaiter of settlement is
+// added to it.
+RtnPromiseResult PromiseAwait(ValuePtr ptr, int awaiter_ref) {
   LOCAL_VALUE(ptr)
-  RtnValue rtn = {};
+  UsageScope usage_scope(iso, ctx);
+  RtnPromiseResult rtn = {};
   Local<Promise> promise = value.As<Promise>();
-  Local<Integer> cbData = Integer::New(iso, callback_ref);
-  Local<Function> func;
-  if (!Function::New(local_ctx, FunctionTemplateCallback, cbData)
-           .ToLocal(&func)) {
-    rtn.error = ExceptionError(try_catch, iso, local_ctx);
+  local_ctx->GetMicrotaskQueue()->PerformCheckpoint(iso);
+
+  rtn.state = promise->State();
+  if (rtn.state == Promise::kPending) {
+    Local<Function> settled;
+    Local<Promise> reaction;
+    if (awaiter_ref != 0 &&
+        !(Function::New(local_ctx, PromiseSettledCallback,
+                        Integer::New(iso, awaiter_ref))
+              .ToLocal(&settled) &&
+          promise->Then(local_ctx, settled, settled).ToLocal(&reaction))) {
+      rtn.error = ExceptionError(try_catch, iso, local_ctx);
+    }
     return rtn;
   }
-  Local<Promise> result;
-  if (!promise->Catch(local_ctx, func).ToLocal(&result)) {
-    rtn.error = ExceptionError(try_catch, iso, local_ctx);
+  if (rtn.state == Promise::kRejected) {
+    rtn.error = RejectionError(try_catch, iso, local_ctx, promise);
     return rtn;
   }
   m_value* result_val = new m_value;
@@ -1576,7 +3689,7 @@ RtnValue PromiseCatch(ValuePtr ptr, int callback_ref) {
   result_val->iso = iso;
   result_val->ctx = ctx;
   result_val->ptr =
-      Persistent<Value, CopyablePersistentTraits<Value>>(iso, result);
+      Persistent<Value, CopyablePersistentTraits<Value>>(iso, promise->Result());
   rtn.value = tracked_value(ctx, result_val);
   return rtn;
 }
@@ -1594,6 +3707,50 @@ ValuePtr PromiseResult(ValuePtr ptr) {
   return tracked_value(ctx, result_val);
 }
 
+static void PromiseRejectHook(PromiseRejectMessage message) {
+  Local<Promise> promise = message.GetPromise();
+  Isolate* iso = promise->GetIsolate();
+  // promises of the internal context have no context reference
+  Local<Context> local_ctx;
+  if (!promise->GetCreationContext().ToLocal(&local_ctx) ||
+      local_ctx->GetNumberOfEmbedderDataFields() < 2) {
+    return;
+  }
+  int ctx_ref = local_ctx->GetEmbedderData(1).As<Integer>()->Value();
+  m_ctx* ctx = goContext(ctx_ref);
+  // the context may already be closed on the Go side
+  if (ctx == nullptr) {
+    return;
+  }
+
+  m_value* promise_val = new m_value;
+  promise_val->id = 0;
+  promise_val->iso = iso;
+  promise_val->ctx = ctx;
+  promise_val->ptr =
+      Persistent<Value, CopyablePersistentTraits<Value>>(iso, promise);
+
+  // there is no value when a handler is added after the rejection
+  ValuePtr value = nullptr;
+  if (!message.GetValue().IsEmpty()) {
+    m_value* val = new m_value;
+    val->id = 0;
+    val->iso = iso;
+    val->ctx = ctx;
+    val->ptr = Persistent<Value, CopyablePersistentTraits<Value>>(
+        iso, message.GetValue());
+    value = tracked_value(ctx, val);
+  }
+  CallbackScope callback_scope(iso, ctx);
+  goPromiseReject(ctx_ref, message.GetEvent(), tracked_value(ctx, promise_val),
+                  value);
+}
+
+void IsolateSetPromiseRejectCallback(IsolatePtr iso, int enabled) {
+  ISOLATE_SCOPE(iso);
+  iso->SetPromiseRejectCallback(enabled ? PromiseRejectHook : nullptr);
+}
+
 /********** Function **********/
 
 static void buildCallArguments(Isolate* iso,
@@ -1607,6 +3764,7 @@ static void buildCallArguments(Isolate* iso,
 
 RtnValue FunctionCall(ValuePtr ptr, ValuePtr recv, int argc, ValuePtr args[]) {
   LOCAL_VALUE(ptr)
+  UsageScope usage_scope(iso, ctx);
 
   RtnValue rtn = {};
   Local<Function> fn = Local<Function>::Cast(value);
@@ -1631,6 +3789,7 @@ RtnValue FunctionCall(ValuePtr ptr, ValuePtr recv, int argc, ValuePtr args[]) {
 
 RtnValue FunctionNewInstance(ValuePtr ptr, int argc, ValuePtr args[]) {
   LOCAL_VALUE(ptr)
+  UsageScope usage_scope(iso, ctx);
   RtnValue rtn = {};
   Local<Function> fn = Local<Function>::Cast(value);
   Local<Value> argv[argc];
@@ -1661,12 +3820,185 @@ ValuePtr FunctionSourceMapUrl(ValuePtr ptr) {
   return tracked_value(ctx, rtnval);
 }
 
+/********** Tape **********/
+
+RtnValue NewValueFromTape(ContextPtr ctx, const uint8_t* data, int length) {
+  LOCAL_CONTEXT(ctx);
+  RtnValue rtn = {};
+
+  TapeReader reader(iso, local_ctx, data, length);
+  Local<Value> result;
+  if (!reader.Read(&result)) {
+    if (try_catch.HasCaught()) {
+      rtn.error = ExceptionError(try_catch, iso, local_ctx);
+    } else {
+      rtn.error.msg = CopyString(reader.error());
+    }
+    return rtn;
+  }
+  m_value* val = new m_value;
+  val->id = 0;
+  val->iso = iso;
+  val->ctx = ctx;
+  val->ptr = Persistent<Value, CopyablePersistentTraits<Value>>(iso, result);
+  rtn.value = tracked_value(ctx, val);
+  return rtn;
+}
+
+RtnBytes ValueToTape(ValuePtr ptr) {
+  LOCAL_VALUE(ptr);
+  RtnBytes rtn = {};
+
+  TapeWriter writer(iso, local_ctx);
+  if (!writer.Write(value)) {
+    if (try_catch.HasCaught()) {
+      rtn.error = ExceptionError(try_catch, iso, local_ctx);
+    } else {
+      rtn.error.msg = CopyString(writer.error());
+    }
+    return rtn;
+  }
+  rtn.data = writer.Release(&rtn.length);
+  return rtn;
+}
+
+/********** Serializer **********/
+
+RtnBytes SerializeValue(ValuePtr ptr) {
+  LOCAL_VALUE(ptr);
+  RtnBytes rtn = {};
+
+  ValueSerializer serializer(iso);
+  serializer.WriteHeader();
+  if (!serializer.WriteValue(local_ctx, value).FromMaybe(false)) {
+    rtn.error = ExceptionError(try_catch, iso, local_ctx);
+    return rtn;
+  }
+  std::pair<uint8_t*, size_t> buf = serializer.Release();
+  rtn.data = buf.first;
+  rtn.length = buf.second;
+  return rtn;
+}
+
+static RtnValue deserialize(m_ctx* ctx,
+                            TryCatch& try_catch,
+                            Local<Context> local_ctx,
+                            ValueDeserializer& deserializer) {
+  Isolate* iso = ctx->iso;
+  RtnValue rtn = {};
+
+  Local<Value> result;
+  if (!deserializer.ReadHeader(local_ctx).FromMaybe(false) ||
+      !deserializer.ReadValue(local_ctx).ToLocal(&result)) {
+    rtn.error = ExceptionError(try_catch, iso, local_ctx);
+    return rtn;
+  }
+  m_value* val = new m_value;
+  val->id = 0;
+  val->iso = iso;
+  val->ctx = ctx;
+  val->ptr = Persistent<Value, CopyablePersistentTraits<Value>>(iso, result);
+  rtn.value = tracked_value(ctx, val);
+  return rtn;
+}
+
+RtnValue DeserializeValue(ContextPtr ctx, const uint8_t* data, int length) {
+  LOCAL_CONTEXT(ctx);
+  ValueDeserializer deserializer(iso, data, length);
+  return deserialize(ctx, try_catch, local_ctx, deserializer);
+}
+
+RtnSerializedValue SerializeValueTransfer(ValuePtr ptr,
+                                          ValuePtr* transfer,
+                                          int transfer_length) {
+  LOCAL_VALUE(ptr);
+  RtnSerializedValue rtn = {};
+
+  std::vector<Local<ArrayBuffer>> buffers;
+  for (int i = 0; i < transfer_length; i++) {
+    Local<Value> buf = transfer[i]->ptr.Get(iso);
+    if (!buf->IsArrayBuffer() || !buf.As<ArrayBuffer>()->IsDetachable() ||
+        buf.As<ArrayBuffer>()->WasDetached()) {
+      rtn.error.msg =
+          CopyString("DataCloneError: transfer list contains a value that is "
+                     "not a detachable ArrayBuffer");
+      return rtn;
+    }
+    for (Local<ArrayBuffer> seen : buffers) {
+      if (seen->StrictEquals(buf)) {
+        rtn.error.msg = CopyString(
+            "DataCloneError: transfer list contains an ArrayBuffer twice");
+        return rtn;
+      }
+    }
+    buffers.push_back(buf.As<ArrayBuffer>());
+  }
+
+  m_serializedValue* out = new m_serializedValue{};
+  SerializerDelegate delegate(iso, out);
+  ValueSerializer serializer(iso, &delegate);
+  serializer.WriteHeader();
+  for (size_t i = 0; i < buffers.size(); i++) {
+    serializer.TransferArrayBuffer(i, buffers[i]);
+  }
+  if (!serializer.WriteValue(local_ctx, value).FromMaybe(false)) {
+    delete out;
+    rtn.error = ExceptionError(try_catch, iso, local_ctx);
+    return rtn;
+  }
+  std::pair<uint8_t*, size_t> buf = serializer.Release();
+  out->data = buf.first;
+  out->length = buf.second;
+
+  // The memory moves over with the backing store, the buffers left behind
+  // are detached as if they had been posted to a worker.
+  for (Local<ArrayBuffer> ab : buffers) {
+    out->arrayBuffers.push_back(ab->GetBackingStore());
+    ab->Detach();
+  }
+  rtn.value = out;
+  return rtn;
+}
+
+RtnValue SerializedValueDeserialize(ContextPtr ctx, SerializedValuePtr ptr) {
+  LOCAL_CONTEXT(ctx);
+  if (ptr->transferred) {
+    RtnValue rtn = {};
+    rtn.error.msg = CopyString(
+        "DataCloneError: transferred ArrayBuffers have already been "
+        "deserialized");
+    return rtn;
+  }
+
+  DeserializerDelegate delegate(ptr);
+  ValueDeserializer deserializer(iso, ptr->data, ptr->length, &delegate);
+  for (size_t i = 0; i < ptr->arrayBuffers.size(); i++) {
+    deserializer.TransferArrayBuffer(
+        i, ArrayBuffer::New(iso, ptr->arrayBuffers[i]));
+  }
+  RtnValue rtn = deserialize(ctx, try_catch, local_ctx, deserializer);
+  if (rtn.value != nullptr && !ptr->arrayBuffers.empty()) {
+    ptr->arrayBuffers.clear();
+    ptr->transferred = true;
+  }
+  return rtn;
+}
+
+void SerializedValueFree(SerializedValuePtr ptr) {
+  free(ptr->data);
+  delete ptr;
+}
+
 /********** v8::V8 **********/
 
 const char* Version() {
   return V8::GetVersion();
 }
 
+uint32_t CachedDataVersionTag() {
+  return ScriptCompiler::CachedDataVersionTag();
+}
+
 void SetFlags(const char* flags) {
   V8::SetFlagsFromString(flags);
 }
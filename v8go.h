@@ -43,15 +43,30 @@ extern const int ScriptCompilerNoCompileOptions;
 extern const int ScriptCompilerConsumeCodeCache;
 extern const int ScriptCompilerEagerCompile;
 
+// GCCallbackFlags values
+extern const int GCCallbackFlagForced;
+
 typedef struct m_ctx m_ctx;
 typedef struct m_value m_value;
 typedef struct m_template m_template;
 typedef struct m_unboundScript m_unboundScript;
+typedef struct m_serializedValue m_serializedValue;
+typedef struct m_backingStore m_backingStore;
+typedef struct m_streamingCompile m_streamingCompile;
+typedef struct m_module m_module;
+typedef struct m_locker m_locker;
+typedef struct m_unlocker m_unlocker;
 
 typedef m_ctx* ContextPtr;
 typedef m_value* ValuePtr;
 typedef m_template* TemplatePtr;
 typedef m_unboundScript* UnboundScriptPtr;
+typedef m_serializedValue* SerializedValuePtr;
+typedef m_backingStore* BackingStorePtr;
+typedef m_streamingCompile* StreamingCompilePtr;
+typedef m_module* ModulePtr;
+typedef m_locker* LockerPtr;
+typedef m_unlocker* UnlockerPtr;
 
 typedef struct {
   const char* msg;
@@ -65,6 +80,12 @@ typedef struct {
   RtnError error;
 } RtnUnboundScript;
 
+typedef struct {
+  ModulePtr ptr;
+  int cachedDataRejected;
+  RtnError error;
+} RtnModule;
+
 typedef struct {
   ScriptCompilerCachedDataPtr ptr;
   const uint8_t* data;
@@ -104,6 +125,18 @@ typedef struct {
   int64_t endTime;
 } CPUProfile;
 
+typedef struct HeapProfileNode {
+  const char* functionName;
+  const char* scriptResourceName;
+  int scriptId;
+  int lineNumber;
+  int columnNumber;
+  size_t selfSize;
+  size_t allocationCount;
+  int childrenCount;
+  struct HeapProfileNode** children;
+} HeapProfileNode;
+
 typedef struct {
   ValuePtr value;
   RtnError error;
@@ -115,6 +148,67 @@ typedef struct {
   RtnError error;
 } RtnString;
 
+typedef struct {
+  int state;
+  ValuePtr value;
+  RtnError error;
+} RtnPromiseResult;
+
+typedef struct {
+  const uint8_t* data;
+  int length;
+  RtnError error;
+} RtnBytes;
+
+typedef struct {
+  SerializedValuePtr value;
+  RtnError error;
+} RtnSerializedValue;
+
+typedef struct {
+  BackingStorePtr ptr;
+  void* data;
+  size_t byte_length;
+} RtnBackingStore;
+
+// Tags of the binary value tape used to marshal values across the Go/C++
+// boundary in a single call, see tape.go for the format.
+typedef enum {
+  TapeUndefined = 0,
+  TapeNull = 1,
+  TapeFalse = 2,
+  TapeTrue = 3,
+  TapeInt32 = 4,
+  TapeFloat64 = 5,
+  TapeString = 6,
+  TapeBigInt = 7,
+  TapeArray = 8,
+  TapeObject = 9,
+  TapeValueRef = 10,
+  TapeOneByteString = 11,
+  TapeKeyRef = 12,
+  TapeCycle = 13,
+  TapeCyclicArray = 14,
+  TapeCyclicObject = 15,
+  TapeBuffer = 16,
+} TapeTag;
+
+// Element types of a TapeBuffer.
+typedef enum {
+  TapeArrayBufferKind = 0,
+  TapeUint8ArrayKind = 1,
+  TapeUint8ClampedArrayKind = 2,
+  TapeInt8ArrayKind = 3,
+  TapeUint16ArrayKind = 4,
+  TapeInt16ArrayKind = 5,
+  TapeUint32ArrayKind = 6,
+  TapeInt32ArrayKind = 7,
+  TapeFloat32ArrayKind = 8,
+  TapeFloat64ArrayKind = 9,
+  TapeBigInt64ArrayKind = 10,
+  TapeBigUint64ArrayKind = 11,
+} TapeBufferKind;
+
 typedef struct {
   size_t total_heap_size;
   size_t total_heap_size_executable;
@@ -127,8 +221,62 @@ typedef struct {
   size_t peak_malloced_memory;
   size_t number_of_native_contexts;
   size_t number_of_detached_contexts;
+  size_t array_buffer_allocated_bytes;
+  size_t array_buffer_peak_bytes;
+  size_t array_buffer_pooled_bytes;
+  size_t array_buffer_failed_allocations;
 } IsolateHStatistics;
 
+typedef struct {
+  const char* space_name;
+  size_t space_size;
+  size_t space_used_size;
+  size_t space_available_size;
+  size_t physical_space_size;
+} HeapSpaceStats;
+
+typedef struct {
+  size_t code_and_metadata_size;
+  size_t bytecode_and_metadata_size;
+  size_t external_script_source_size;
+  size_t cpu_profiler_metadata_size;
+} HeapCodeStats;
+
+typedef struct {
+  const char* object_type;
+  const char* object_sub_type;
+  size_t object_count;
+  size_t object_size;
+} HeapObjectStats;
+
+typedef struct {
+  int gc_type;
+  int flags;
+  int64_t start;
+  uint64_t duration;
+  size_t used_before;
+  size_t used_after;
+} GCEvent;
+
+typedef struct {
+  uint64_t count;
+  uint64_t total;
+  uint64_t max;
+} GCStats;
+
+typedef struct {
+  uint64_t cpu_ns;
+  uint64_t wall_ns;
+  uint64_t entries;
+  uint64_t callback_ns;
+  uint64_t callbacks;
+} ExecutionUsage;
+
+typedef struct {
+  size_t arrayBufferMaxBytes;
+  int arrayBufferPooling;
+} IsolateOptions;
+
 typedef struct {
   const uint64_t* word_array;
   int word_count;
@@ -136,12 +284,30 @@ typedef struct {
 } ValueBigInt;
 
 extern void Init();
-extern IsolatePtr NewIsolate();
+extern IsolatePtr NewIsolate(IsolateOptions options);
 extern void IsolatePerformMicrotaskCheckpoint(IsolatePtr ptr);
 extern void IsolateDispose(IsolatePtr ptr);
 extern void IsolateTerminateExecution(IsolatePtr ptr);
+extern void IsolateCancelTerminateExecution(IsolatePtr ptr);
+extern LockerPtr IsolateLock(IsolatePtr ptr);
+extern void IsolateUnlock(LockerPtr ptr);
+extern void IsolateRequestInterrupt(IsolatePtr ptr, int ref);
+extern UnlockerPtr IsolateYield(IsolatePtr ptr);
+extern void IsolateResume(UnlockerPtr ptr);
 extern int IsolateIsExecutionTerminating(IsolatePtr ptr);
 extern IsolateHStatistics IsolationGetHeapStatistics(IsolatePtr ptr);
+extern ExecutionUsage IsolateGetExecutionUsage(IsolatePtr ptr);
+extern int IsolateNumberOfHeapSpaces(IsolatePtr ptr);
+extern HeapSpaceStats IsolateGetHeapSpaceStatistics(IsolatePtr ptr, int index);
+extern HeapCodeStats IsolateGetHeapCodeStatistics(IsolatePtr ptr);
+extern int IsolateNumberOfTrackedHeapObjectTypes(IsolatePtr ptr);
+extern int IsolateGetHeapObjectStatistics(IsolatePtr ptr,
+                                          int index,
+                                          HeapObjectStats* stats);
+extern void IsolateStartGCTracking(IsolatePtr ptr);
+extern void IsolateStopGCTracking(IsolatePtr ptr);
+extern int IsolateTakeGCEvents(IsolatePtr ptr, GCEvent* events, int max);
+extern GCStats IsolateGetGCStatistics(IsolatePtr ptr, int type);
 
 extern ValuePtr IsolateThrowException(IsolatePtr iso, ValuePtr value);
 
@@ -149,12 +315,42 @@ extern RtnUnboundScript IsolateCompileUnboundScript(IsolatePtr iso_ptr,
                                                     const char* source,
                                                     const char* origin,
                                                     CompileOptions options);
+extern StreamingCompilePtr IsolateStartStreamingCompile(IsolatePtr iso_ptr,
+                                                        const char* s,
+                                                        int len);
+extern StreamingCompilePtr IsolateStartStreamingCompileReader(
+    IsolatePtr iso_ptr,
+    int reader_ref);
+extern void StreamingCompileRun(StreamingCompilePtr ptr);
+extern RtnUnboundScript StreamingCompileFinish(IsolatePtr iso_ptr,
+                                               StreamingCompilePtr ptr,
+                                               const char* o);
 extern ScriptCompilerCachedData* UnboundScriptCreateCodeCache(
     IsolatePtr iso_ptr,
     UnboundScriptPtr us_ptr);
 extern void ScriptCompilerCachedDataDelete(
     ScriptCompilerCachedData* cached_data);
 extern RtnValue UnboundScriptRun(ContextPtr ctx_ptr, UnboundScriptPtr us_ptr);
+extern void UnboundScriptRelease(IsolatePtr iso_ptr, UnboundScriptPtr us_ptr);
+
+extern RtnModule CompileModule(ContextPtr ctx_ptr,
+                               const char* s,
+                               const char* o,
+                               CompileOptions opts);
+extern RtnError ModuleInstantiate(ContextPtr ctx_ptr, ModulePtr ptr);
+extern RtnValue ModuleEvaluate(ContextPtr ctx_ptr, ModulePtr ptr);
+extern ValuePtr ModuleGetNamespace(ContextPtr ctx_ptr, ModulePtr ptr);
+extern int ModuleGetStatus(ContextPtr ctx_ptr, ModulePtr ptr);
+extern int ModuleGetRequestsLength(ContextPtr ctx_ptr, ModulePtr ptr);
+extern const char* ModuleGetRequest(ContextPtr ctx_ptr, ModulePtr ptr, int i);
+extern ScriptCompilerCachedData* ModuleCreateCodeCache(ContextPtr ctx_ptr,
+                                                       ModulePtr ptr);
+extern void DynamicImportResolve(ContextPtr ctx_ptr,
+                                 ValuePtr resolver_ptr,
+                                 ModulePtr ptr);
+extern void DynamicImportReject(ContextPtr ctx_ptr,
+                                ValuePtr resolver_ptr,
+                                const char* msg);
 
 extern CPUProfiler* NewCPUProfiler(IsolatePtr iso_ptr);
 extern void CPUProfilerDispose(CPUProfiler* ptr);
@@ -163,17 +359,43 @@ extern CPUProfile* CPUProfilerStopProfiling(CPUProfiler* ptr,
                                             const char* title);
 extern void CPUProfileDelete(CPUProfile* ptr);
 
+extern void HeapProfilerTakeSnapshot(IsolatePtr iso_ptr, int writer_ref);
+extern int HeapProfilerStartSampling(IsolatePtr iso_ptr,
+                                     uint64_t interval,
+                                     int depth);
+extern void HeapProfilerStopSampling(IsolatePtr iso_ptr);
+extern HeapProfileNode* HeapProfilerGetAllocationProfile(IsolatePtr iso_ptr);
+extern void HeapProfileNodeDelete(HeapProfileNode* ptr);
+
 extern ContextPtr NewContext(IsolatePtr iso_ptr,
                              TemplatePtr global_template_ptr,
-                             int ref);
+                             int ref,
+                             int microtasks_policy);
+extern ExecutionUsage ContextGetExecutionUsage(ContextPtr ctx);
 extern int ContextRetainedValueCount(ContextPtr ctx);
 extern void ContextFree(ContextPtr ptr);
+extern void ContextPerformMicrotaskCheckpoint(ContextPtr ctx);
 extern RtnValue RunScript(ContextPtr ctx_ptr,
                           const char* source,
                           const char* origin);
 extern RtnValue JSONParse(ContextPtr ctx_ptr, const char* str);
 const char* JSONStringify(ContextPtr ctx_ptr, ValuePtr val_ptr);
 extern ValuePtr ContextGlobal(ContextPtr ctx_ptr);
+extern RtnValue NewValueFromTape(ContextPtr ctx_ptr,
+                                 const uint8_t* data,
+                                 int length);
+extern RtnBytes ValueToTape(ValuePtr ptr);
+
+extern RtnBytes SerializeValue(ValuePtr ptr);
+extern RtnValue DeserializeValue(ContextPtr ctx_ptr,
+                                 const uint8_t* data,
+                                 int length);
+extern RtnSerializedValue SerializeValueTransfer(ValuePtr ptr,
+                                                 ValuePtr* transfer,
+                                                 int transfer_length);
+extern RtnValue SerializedValueDeserialize(ContextPtr ctx_ptr,
+                                           SerializedValuePtr ptr);
+extern void SerializedValueFree(SerializedValuePtr ptr);
 
 extern void TemplateFreeWrapper(TemplatePtr ptr);
 extern void TemplateSetValue(TemplatePtr ptr,
@@ -287,15 +509,28 @@ int ObjectHasIdx(ValuePtr ptr, uint32_t idx);
 int ObjectDelete(ValuePtr ptr, const char* key);
 int ObjectDeleteIdx(ValuePtr ptr, uint32_t idx);
 
+extern RtnValue NewArrayBuffer(ContextPtr ctx_ptr,
+                               const void* data,
+                               size_t byte_length);
+extern size_t ArrayBufferByteLength(ValuePtr ptr);
+extern ValuePtr ArrayBufferViewBuffer(ValuePtr ptr);
+extern size_t ArrayBufferViewByteOffset(ValuePtr ptr);
+extern size_t ArrayBufferViewByteLength(ValuePtr ptr);
+extern RtnBackingStore ValueGetBackingStore(ValuePtr ptr);
+extern void BackingStoreRelease(BackingStorePtr ptr);
+
+extern RtnBackingStore NewSharedMemory(size_t byte_length);
+extern RtnValue NewSharedArrayBuffer(ContextPtr ctx, BackingStorePtr store);
+
 extern RtnValue NewPromiseResolver(ContextPtr ctx_ptr);
 extern ValuePtr PromiseResolverGetPromise(ValuePtr ptr);
 int PromiseResolverResolve(ValuePtr ptr, ValuePtr val_ptr);
 int PromiseResolverReject(ValuePtr ptr, ValuePtr val_ptr);
 int PromiseState(ValuePtr ptr);
-RtnValue PromiseThen(ValuePtr ptr, int callback_ref);
 RtnValue PromiseThen2(ValuePtr ptr, int on_fulfilled_ref, int on_rejected_ref);
-RtnValue PromiseCatch(ValuePtr ptr, int callback_ref);
 extern ValuePtr PromiseResult(ValuePtr ptr);
+extern RtnPromiseResult PromiseAwait(ValuePtr ptr, int awaiter_ref);
+extern void IsolateSetPromiseRejectCallback(IsolatePtr ptr, int enabled);
 
 extern RtnValue FunctionCall(ValuePtr ptr,
                              ValuePtr recv,
@@ -305,6 +540,7 @@ RtnValue FunctionNewInstance(ValuePtr ptr, int argc, ValuePtr args[]);
 ValuePtr FunctionSourceMapUrl(ValuePtr ptr);
 
 const char* Version();
+extern uint32_t CachedDataVersionTag();
 extern void SetFlags(const char* flags);
 
 #ifdef __cplusplus
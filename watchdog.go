@@ -0,0 +1,146 @@
+// Copyright 2023 the v8go contributors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+package v8go
+
+// #include "v8go.h"
+import "C"
+
+import (
+	"container/heap"
+	"errors"
+	"runtime"
+	"sync"
+	"sync/atomic"
+	"time"
+)
+
+// ErrDeadlineExceeded is returned by the calls that are terminated for running
+// past their deadline, such as Context.RunScriptWithTimeout.
+var ErrDeadlineExceeded = errors.New("v8go: execution deadline exceeded")
+
+// watchdog terminates the calls that run past their deadline. A single
+// goroutine serves the calls of all isolates, sleeping until the earliest
+// deadline, instead of one timer goroutine per call.
+type watchdog struct {
+	once    sync.Once
+	mu      sync.Mutex
+	watches watchQueue
+	wake    chan struct{}
+}
+
+type watch struct {
+	iso      *Isolate
+	deadline time.Time
+	index    int
+	fired    bool
+}
+
+var executionWatchdog = &watchdog{wake: make(chan struct{}, 1)}
+
+// withDeadline runs fn, which calls into the isolate, terminating it once the
+// deadline has passed, and reports whether it was terminated. The isolate is
+// held for the whole of fn, so the termination can only ever hit fn's calls,
+// and it is cancelled before the isolate is released to the next call. For
+// the same reason, Interrupt.Yield does not release the isolate meanwhile.
+func (i *Isolate) withDeadline(deadline time.Time, fn func()) (terminated bool) {
+	runtime.LockOSThread()
+	defer runtime.UnlockOSThread()
+	locker := C.IsolateLock(i.ptr)
+	defer C.IsolateUnlock(locker)
+	atomic.AddInt32(&i.terminable, 1)
+	defer atomic.AddInt32(&i.terminable, -1)
+
+	w := executionWatchdog.start(i, deadline)
+	fn()
+	if executionWatchdog.stop(w) {
+		C.IsolateCancelTerminateExecution(i.ptr)
+		return true
+	}
+	return false
+}
+
+func (d *watchdog) start(iso *Isolate, deadline time.Time) *watch {
+	d.once.Do(func() { go d.run() })
+	w := &watch{iso: iso, deadline: deadline}
+	d.mu.Lock()
+	heap.Push(&d.watches, w)
+	earliest := d.watches[0] == w
+	d.mu.Unlock()
+	if earliest {
+		select {
+		case d.wake <- struct{}{}:
+		default:
+		}
+	}
+	return w
+}
+
+// stop stops watching the call and reports whether it was terminated.
+func (d *watchdog) stop(w *watch) bool {
+	d.mu.Lock()
+	defer d.mu.Unlock()
+	if w.index >= 0 {
+		heap.Remove(&d.watches, w.index)
+	}
+	return w.fired
+}
+
+func (d *watchdog) run() {
+	timer := time.NewTimer(time.Hour)
+	for {
+		d.mu.Lock()
+		now := time.Now()
+		for len(d.watches) > 0 && !d.watches[0].deadline.After(now) {
+			w := heap.Pop(&d.watches).(*watch)
+			w.fired = true
+			w.iso.TerminateExecution()
+		}
+		next := time.Hour
+		if len(d.watches) > 0 {
+			next = d.watches[0].deadline.Sub(now)
+		}
+		d.mu.Unlock()
+
+		if !timer.Stop() {
+			select {
+			case <-timer.C:
+			default:
+			}
+		}
+		timer.Reset(next)
+		select {
+		case <-timer.C:
+		case <-d.wake:
+		}
+	}
+}
+
+// watchQueue is a heap of watches ordered by deadline.
+type watchQueue []*watch
+
+func (q watchQueue) Len() int { return len(q) }
+
+func (q watchQueue) Less(i, j int) bool { return q[i].deadline.Before(q[j].deadline) }
+
+func (q watchQueue) Swap(i, j int) {
+	q[i], q[j] = q[j], q[i]
+	q[i].index = i
+	q[j].index = j
+}
+
+func (q *watchQueue) Push(x interface{}) {
+	w := x.(*watch)
+	w.index = len(*q)
+	*q = append(*q, w)
+}
+
+func (q *watchQueue) Pop() interface{} {
+	old := *q
+	w := old[len(old)-1]
+	old[len(old)-1] = nil
+	w.index = -1
+	*q = old[:len(old)-1]
+	return w
+}